@@ -0,0 +1,64 @@
+#pragma once
+
+#include <new>
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace cubedemo
+{
+    // Size of a cache line on all platforms we care about
+    const size_t CACHE_LINE_SIZE = 64;
+
+    // Allocator returning memory aligned to a cache line, so that
+    // arrays can be split into chunks without sharing cache lines between threads
+    template<typename T>
+    struct AlignedAllocator
+    {
+        typedef T value_type;
+
+        template<typename U>
+        struct rebind { typedef AlignedAllocator<U> other; };
+
+        AlignedAllocator() = default;
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U>&) { }
+
+        T* allocate(size_t n)
+        {
+            void *ptr = nullptr;
+#ifdef _MSC_VER
+            ptr = _aligned_malloc(n * sizeof(T), CACHE_LINE_SIZE);
+#else
+            if (posix_memalign(&ptr, CACHE_LINE_SIZE, n * sizeof(T)) != 0)
+                ptr = nullptr;
+#endif
+            if (ptr == nullptr)
+                throw std::bad_alloc();
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T *ptr, size_t)
+        {
+#ifdef _MSC_VER
+            _aligned_free(ptr);
+#else
+            free(ptr);
+#endif
+        }
+    };
+
+    template<typename T, typename U>
+    inline bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+
+    template<typename T, typename U>
+    inline bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
+    // A std::vector with cache line aligned storage
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+}
@@ -0,0 +1,73 @@
+#include "AllocationCounter.hpp"
+
+#include <new>
+#include <cstdlib>
+
+#ifndef NDEBUG
+#define CD_COUNT_ALLOCATIONS
+#endif
+
+#ifdef CD_COUNT_ALLOCATIONS
+// Plain integer, so the first allocation of a thread doesn't have to construct anything
+static thread_local uint64_t allocations = 0;
+
+static void* countedAllocate(std::size_t size)
+{
+    allocations++;
+    if (size == 0)
+        size = 1;
+    while (true)
+    {
+        auto pointer = std::malloc(size);
+        if (pointer != nullptr)
+            return pointer;
+        auto handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void* countedAllocateNoThrow(std::size_t size)
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+// Replacements of the global allocation functions, all other forms call these
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocateNoThrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocateNoThrow(size); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+#endif
+
+namespace cubedemo
+{
+    bool allocationCountingEnabled()
+    {
+#ifdef CD_COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t allocationCount()
+    {
+#ifdef CD_COUNT_ALLOCATIONS
+        return allocations;
+#else
+        return 0;
+#endif
+    }
+}
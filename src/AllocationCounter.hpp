@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cubedemo
+{
+    // Counts heap allocations made through the global operator new, to check that code
+    // which should not allocate really doesn't. Only counts in debug builds (without NDEBUG).
+    // Every thread has a count of its own, so allocations of driver or library threads don't get in the way.
+
+    bool allocationCountingEnabled();
+    uint64_t allocationCount(); // Allocations by the calling thread so far, always 0 if counting is disabled
+}
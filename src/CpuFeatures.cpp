@@ -0,0 +1,73 @@
+#include "CpuFeatures.hpp"
+
+#if defined(CD_ARCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace cubedemo
+{
+    static SimdLevel detectSimdLevel()
+    {
+#if defined(CD_ARCH_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        auto maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+
+        // Check that the OS saves the wider registers on context switches
+        auto xcr0 = osxsave ? _xgetbv(0) : 0;
+        bool osYmm = (xcr0 & 0x06) == 0x06;
+        bool osZmm = (xcr0 & 0xe6) == 0xe6;
+
+        bool avx2 = false, avx512f = false;
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+            avx512f = (info[1] & (1 << 16)) != 0;
+        }
+
+        if (avx512f && osZmm)
+            return SimdLevel::AVX512;
+        if (avx && avx2 && osYmm)
+            return SimdLevel::AVX2;
+        if (sse2)
+            return SimdLevel::SSE2;
+        return SimdLevel::Scalar;
+#elif defined(CD_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+        // These builtins also check for OS support of the extended register state
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return SimdLevel::SSE2;
+        return SimdLevel::Scalar;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    SimdLevel simdLevel()
+    {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    const char* simdLevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default: return "Scalar";
+        }
+    }
+}
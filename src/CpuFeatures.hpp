@@ -0,0 +1,35 @@
+#pragma once
+
+// Helpers for compiling single functions for a specific instruction set.
+// Such functions must only be called after checking simdLevel() at runtime.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CD_ARCH_X86
+#endif
+
+#if defined(CD_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CD_TARGET_SSE2 __attribute__((target("sse2")))
+#define CD_TARGET_AVX2 __attribute__((target("avx2")))
+#define CD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define CD_TARGET_SSE2
+#define CD_TARGET_AVX2
+#define CD_TARGET_AVX512
+#endif
+
+namespace cubedemo
+{
+    // The widest SIMD instruction set usable on this machine
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512,
+    };
+
+    // Detect the supported instruction sets (only done once, the result is cached)
+    SimdLevel simdLevel();
+
+    // Returns a human-readable name for the given level, for logging
+    const char* simdLevelName(SimdLevel level);
+}
@@ -1,10 +1,13 @@
 #include "CubeController.hpp"
 
 #include <cmath>
-#include <random>
+#include <limits>
+#include <algorithm>
+#include <functional>
 
 #include <glm/geometric.hpp>
 #include "Util.hpp"
+#include "Random.hpp"
 
 namespace cubedemo
 {
@@ -17,23 +20,79 @@ namespace cubedemo
         states.resize(size);
         helices.resize(size);
         positions.resize(size);
+        previousPositions.resize(size);
         rotationAxes.resize(size);
         rotationSpeeds.resize(size);
         opacities.resize(size);
+        previousOpacities.resize(size);
         scales.resize(size);
         startTimes.resize(size);
+        fadeOutTimes.resize(size);
     }
 
     // // //
-    // CubeRenderer implementation
+    // CubeDirtyRanges implementation
     // // //
 
+    CubeDirtyRanges::CubeDirtyRanges(size_t maxRanges)
+        : spawned{ maxRanges }
+    {
+    }
+
+    void CubeDirtyRanges::clear()
+    {
+        spawned.clear();
+    }
+
+    // // //
+    // CubeController implementation
+    // // //
+
+    static const float DESPAWN_HEIGHT = -70.0f; // Cubes start to fade out once they sink below this height
+
+    // Cubes are updated in blocks, so their data stays in the L1 cache between the phases of an update
+    static const size_t UPDATE_BLOCK_SIZE = 256;
+
     static float deltaOpacity(float seconds, const GameTimePoint& time)
     {
         return (1.0f / seconds) * 0.001f * time.delta();
     }
 
-    static int aliveCubesForTime(const GameTimePoint& time, int maxCubes)
+    // The age at which a cube starts fading out, which is when it has
+    // faded in completely, and sunk below the despawn height
+    static float fadeOutAge(const HelixData& helix)
+    {
+        auto sinkRate = helix.h * CUBE_HELIX_TIME_SCALE;
+        if (sinkRate >= 0.0f)
+            return std::numeric_limits<float>::infinity();
+        return std::max(CUBE_FADE_SECONDS, (DESPAWN_HEIGHT - helix.position.y) / sinkRate);
+    }
+
+    static CubeState analyticState(float age, float fadeOutAge)
+    {
+        // Every threshold passed moves on to the next state, counting FadeIn, Moving, FadeOut, and wrapping around to Dead.
+        // Fading in always takes precedence, even when rounding puts the fade out age slightly below the fade time.
+        static_assert(int(CubeState::Dead) == 0 && int(CubeState::FadeIn) == 1 && int(CubeState::Moving) == 2 && int(CubeState::FadeOut) == 3,
+            "States must be in the order they are passed through");
+        auto passed = int(age >= CUBE_FADE_SECONDS) + int(age >= std::max(fadeOutAge, CUBE_FADE_SECONDS)) + int(age >= fadeOutAge + CUBE_FADE_SECONDS);
+        return CubeState((1 + passed) & 3);
+    }
+
+    static float analyticOpacity(float age, float fadeOutAge)
+    {
+        auto fadeIn = age / CUBE_FADE_SECONDS;
+        auto fadeOut = (fadeOutAge + CUBE_FADE_SECONDS - age) / CUBE_FADE_SECONDS;
+        return std::max(0.0f, std::min(1.0f, std::min(fadeIn, fadeOut)));
+    }
+
+#ifndef NDEBUG
+    static bool sampleEquals(const CubeSample& sample, CubeState state, float opacity, const glm::vec3& position)
+    {
+        return sample.state == state && sample.opacity == opacity && sample.position == position;
+    }
+#endif
+
+    int CubeController::aliveCubesForTime(const GameTimePoint& time, int maxCubes)
     {
 	    auto cubes = 2.0f * time.total();
         if (time.total() > 8.0f)
@@ -41,72 +100,211 @@ namespace cubedemo
         return int(fmin(maxCubes, cubes));
     }
 
-    CubeController::CubeController(int count)
-        : m_cubeCount{ count }, m_aliveCubes{ 0 }, m_cubeStates{ count }
+    CubeController::CubeController(int count, uint64_t seed)
+        : m_cubeCount{ count }, m_cubeStates{ count }, m_workers{ nullptr }, m_updateMode{ CubeUpdateMode::Integrated },
+        m_seed{ seed }, m_spawnSequence{ 0 }
     {
         CC_ASSERT(count > 0)
+
+        // Fill the stack so that the lowest slots are used first
+        m_freeSlots.reserve(count);
+        for (auto i = count; i > 0; i--)
+            m_freeSlots.push_back(uint32_t(i - 1));
+        m_mergedFreeSlots.reserve(count);
+        m_aliveIndices.reserve(count);
     }
 
-    void CubeController::update(const GameTimePoint& time)
+    void CubeController::forEachRange(size_t count, const WorkerPool::RangeFunction& function)
     {
-        // TODO: Change random number generation to be less shitty
-        static std::default_random_engine randEngine;
-        static std::uniform_real_distribution<float> startRandDistrib{ -1.0f, 1.0f };
-        static std::normal_distribution<float> movementRandDistrib{ 10.0f, 2.0f };
-        static std::normal_distribution<float> scaleRandDistrib{ 1.0f, 0.20f };
+        // Single-threaded updates go through the same chunks, so both work on the same blocks of cubes
+        if (m_workers != nullptr)
+            m_workers->parallelFor(count, UPDATE_CHUNK_SIZE, function);
+        else
+        {
+            for (size_t begin = 0; begin < count; begin += UPDATE_CHUNK_SIZE)
+                function(begin, std::min(count, begin + UPDATE_CHUNK_SIZE));
+        }
+    }
+
+    void CubeController::spawnRange(const GameTimePoint& time, size_t begin, size_t end, uint64_t firstSequence)
+    {
+        for (size_t k = begin; k < end; k++)
+        {
+            auto i = m_aliveIndices[k];
+
+            // Every spawn draws from its own stream, identified by its sequence number and slot,
+            // so the result doesn't depend on which thread spawns which cube
+            auto sequence = firstSequence + (k - begin);
+            RandomStream random{ m_seed, (sequence << 32) | i };
+
+            float uniforms[5]; // axis xyz, position x and z
+            random.fillUniform(uniforms, 5, -1.0f, 1.0f);
+            float scaleNormals[2]; // scale, rotation speed
+            random.fillNormal(scaleNormals, 2, 1.0f, 0.20f);
+            float movementNormals[3]; // t0, r, h
+            random.fillNormal(movementNormals, 3, 10.0f, 2.0f);
+
+            // When a cube spawns, fill in a bunch of random data
+            m_cubeStates.states[i] = CubeState::FadeIn;
+            m_cubeStates.scales[i] = scaleNormals[0];
+            m_cubeStates.rotationAxes[i] = glm::normalize(glm::vec3{ uniforms[0], uniforms[1], uniforms[2] });
+            m_cubeStates.rotationSpeeds[i] = 0.8f * scaleNormals[1] * random.sign();
+            m_cubeStates.startTimes[i] = time.total(); // save in seconds
+            HelixData helix;
+            helix.t0 = movementNormals[0];
+            helix.position = glm::vec3(uniforms[3] * 125, 70, 150 + uniforms[4] * 100);
+            helix.r = 2 * movementNormals[1] * random.sign();
+            helix.h = -7 * movementNormals[2];
+            m_cubeStates.helices.set(i, helix);
+            m_cubeStates.fadeOutTimes[i] = time.total() + fadeOutAge(helix);
+
+            // Start out at the beginning of the curve, so interpolating from
+            // the previous update doesn't use data of the slot's previous cube
+            m_cubeStates.positions[i] = mapOntoHelixAt(m_cubeStates.helices, m_cubeStates.startTimes.data(), time.total(), CUBE_HELIX_TIME_SCALE, i);
+            m_cubeStates.opacities[i] = 0.0f;
+        }
+    }
 
-	    auto aliveCubesThisFrame = aliveCubesForTime(time, m_cubeCount);
+    // Updates go through phases for every block of cubes: compute new opacities and states from the old ones
+    // without branches, evaluate the positions of the whole block, then apply the transitions that depend on positions.
+    // Blocks are small enough that the phases after the first one find their data in the L1 cache.
 
-        for (size_t i = 0; i < m_cubeCount; i++)
+    void CubeController::updateRangeIntegrated(const GameTimePoint& time, size_t begin, size_t end)
+    {
+        auto delta = deltaOpacity(CUBE_FADE_SECONDS, time);
+        for (auto blockBegin = begin; blockBegin < end; blockBegin += UPDATE_BLOCK_SIZE)
         {
-            if (m_cubeStates.states[i] == CubeState::Dead)
+            auto count = std::min(end - blockBegin, UPDATE_BLOCK_SIZE);
+            auto indices = m_aliveIndices.data() + blockBegin;
+
+            // Fade in or out over 3 seconds. Cubes that reach full opacity stop fading in,
+            // and cubes that reach zero opacity die. Moving cubes keep their opacity of 1.
+            for (size_t n = 0; n < count; n++)
             {
-                if (m_aliveCubes < aliveCubesThisFrame)
-                {
-                    // When a cube spawns, fill in a bunch of random data
-                    m_cubeStates.states[i] = CubeState::FadeIn;
-                    m_cubeStates.scales[i] = scaleRandDistrib(randEngine);
-                    m_cubeStates.rotationAxes[i] = glm::normalize(glm::vec3{ startRandDistrib(randEngine), startRandDistrib(randEngine), startRandDistrib(randEngine) });
-                    m_cubeStates.rotationSpeeds[i] = 0.8f * scaleRandDistrib(randEngine) * (std::signbit(startRandDistrib(randEngine)) ? 1.0f : -1.0f);
-                    m_cubeStates.startTimes[i] = time.total(); // save in seconds
-                    m_cubeStates.helices[i].t0 = movementRandDistrib(randEngine);
-                    m_cubeStates.helices[i].position = glm::vec3(startRandDistrib(randEngine) * 125, 70, 150 + startRandDistrib(randEngine) * 100);
-                    m_cubeStates.helices[i].r = 2 * movementRandDistrib(randEngine) * (std::signbit(startRandDistrib(randEngine)) ? 1.0f : -1.0f);
-                    m_cubeStates.helices[i].h = -7 * movementRandDistrib(randEngine);
-                    m_aliveCubes++;
-                }
+                auto i = indices[n];
+                m_cubeStates.previousPositions[i] = m_cubeStates.positions[i];
+                m_cubeStates.previousOpacities[i] = m_cubeStates.opacities[i];
+
+                auto previousState = m_cubeStates.states[i];
+                auto fadeIn = previousState == CubeState::FadeIn;
+                auto fadeOut = previousState == CubeState::FadeOut;
+                auto opacity = m_cubeStates.opacities[i] + delta * (float(fadeIn) - float(fadeOut));
+                auto state = (fadeIn & (opacity >= 1.0f)) ? CubeState::Moving : previousState;
+                state = (fadeOut & (opacity <= 0.0f)) ? CubeState::Dead : state;
+                m_cubeStates.states[i] = state;
+                m_cubeStates.opacities[i] = std::min(1.0f, std::max(0.0f, opacity));
             }
 
-            if (m_cubeStates.states[i] == CubeState::FadeIn)
+            // Evaluate the helices of the whole block in one batch. Cubes that just died
+            // are evaluated as well, that is cheaper than breaking up the batch.
+            mapOntoHelixIndexed(m_cubeStates.helices, m_cubeStates.startTimes.data(), time.total(), CUBE_HELIX_TIME_SCALE, indices, count, m_cubeStates.positions.data());
+
+            // Moving cubes start to fade out below the despawn height
+            for (size_t n = 0; n < count; n++)
             {
-                // Fade in over 3 seconds
-                m_cubeStates.opacities[i] += deltaOpacity(3.0f, time);
-                // Once the opacity reaches 1, stop fading in
-                if (m_cubeStates.opacities[i] >= 1.0f)
-                {
-                    m_cubeStates.opacities[i] = 1.0f;
-                    m_cubeStates.states[i] = CubeState::Moving;
-                }
+                auto i = indices[n];
+                auto state = m_cubeStates.states[i];
+                auto despawn = (state == CubeState::Moving) & (m_cubeStates.positions[i].y < DESPAWN_HEIGHT);
+                m_cubeStates.states[i] = despawn ? CubeState::FadeOut : state;
             }
+        }
+    }
 
-            if (m_cubeStates.states[i] == CubeState::FadeOut)
+    void CubeController::updateRangeAnalytic(const GameTimePoint& time, size_t begin, size_t end)
+    {
+        // States and opacities only depend on the current time, nothing is accumulated
+        for (auto blockBegin = begin; blockBegin < end; blockBegin += UPDATE_BLOCK_SIZE)
+        {
+            auto count = std::min(end - blockBegin, UPDATE_BLOCK_SIZE);
+            auto indices = m_aliveIndices.data() + blockBegin;
+            for (size_t n = 0; n < count; n++)
             {
-                // Fade out over 3 seconds
-                m_cubeStates.opacities[i] -= deltaOpacity(3.0f, time);
-                // If opacity reaches 0, kill the cube
-                if (m_cubeStates.opacities[i] <= 0.0f)
-                {
-                    m_cubeStates.opacities[i] = 0.0f;
-                    m_cubeStates.states[i] = CubeState::Dead;
-                    m_aliveCubes--;
-                }
+                auto i = indices[n];
+                m_cubeStates.previousPositions[i] = m_cubeStates.positions[i];
+                m_cubeStates.previousOpacities[i] = m_cubeStates.opacities[i];
+
+                auto age = time.total() - m_cubeStates.startTimes[i];
+                auto fadeOutAge = m_cubeStates.fadeOutTimes[i] - m_cubeStates.startTimes[i];
+                m_cubeStates.states[i] = analyticState(age, fadeOutAge);
+                m_cubeStates.opacities[i] = analyticOpacity(age, fadeOutAge);
             }
 
-            if (m_cubeStates.states[i] != CubeState::Dead)
-                m_cubeStates.positions[i] = mapOntoHelix(m_cubeStates.helices[i], 0.1f * (time.total() - m_cubeStates.startTimes[i]));
+            mapOntoHelixIndexed(m_cubeStates.helices, m_cubeStates.startTimes.data(), time.total(), CUBE_HELIX_TIME_SCALE, indices, count, m_cubeStates.positions.data());
+        }
+    }
 
-            if (m_cubeStates.states[i] == CubeState::Moving && m_cubeStates.positions[i].y < -70.0f)
-                m_cubeStates.states[i] = CubeState::FadeOut;
+    void CubeController::update(const GameTimePoint& time)
+    {
+        // Move the slots of newly spawned cubes from the free stack to the alive list.
+        // Cubes that die during this update only free up their slot for the next one.
+        auto spawnCount = std::max(0, aliveCubesForTime(time, m_cubeCount) - int(m_aliveIndices.size()));
+        spawnCount = std::min(spawnCount, int(m_freeSlots.size()));
+        auto firstSpawn = m_aliveIndices.size();
+        for (auto n = 0; n < spawnCount; n++)
+        {
+            m_aliveIndices.push_back(m_freeSlots.back());
+            m_freeSlots.pop_back();
         }
+
+        // Free slots are popped lowest first, so the used slots stay packed at the start of the arrays.
+        // Spawns into slots that were never used extend one range, the ones refilling gaps usually don't.
+        for (auto k = firstSpawn; k < m_aliveIndices.size(); k++)
+            m_dirtyRanges.spawned.add(m_aliveIndices[k]);
+
+        forEachRange(size_t(spawnCount), [&](size_t begin, size_t end) { spawnRange(time, firstSpawn + begin, firstSpawn + end, m_spawnSequence + begin); });
+        m_spawnSequence += spawnCount;
+        if (m_updateMode == CubeUpdateMode::Analytic)
+            forEachRange(m_aliveIndices.size(), [&](size_t begin, size_t end) { updateRangeAnalytic(time, begin, end); });
+        else
+            forEachRange(m_aliveIndices.size(), [&](size_t begin, size_t end) { updateRangeIntegrated(time, begin, end); });
+
+        // Remove dead cubes from the alive list and return their slots to the free stack
+        auto firstFreed = m_freeSlots.size();
+        size_t aliveCount = 0;
+        for (auto i : m_aliveIndices)
+        {
+            if (m_cubeStates.states[i] == CubeState::Dead)
+            {
+                // Dead cubes aren't updated anymore, so make them stay invisible when interpolated
+                m_cubeStates.previousOpacities[i] = 0.0f;
+                m_cubeStates.opacities[i] = 0.0f;
+                m_freeSlots.push_back(i);
+            }
+            else
+                m_aliveIndices[aliveCount++] = i;
+        }
+        m_aliveIndices.resize(aliveCount);
+
+#ifndef NDEBUG
+        // Analytic updates have to agree exactly with evaluating the cubes, so seeking to a time matches stepping there
+        if (m_updateMode == CubeUpdateMode::Analytic)
+        {
+            for (auto i : m_aliveIndices)
+                CC_ASSERT(sampleEquals(evaluateCube(i, time.total()), m_cubeStates.states[i], m_cubeStates.opacities[i], m_cubeStates.positions[i]))
+        }
+#endif
+
+        // Slots die in alive list order, merge them into the stack so it stays sorted
+        if (m_freeSlots.size() > firstFreed)
+        {
+            auto freed = m_freeSlots.begin() + firstFreed;
+            std::sort(freed, m_freeSlots.end(), std::greater<uint32_t>());
+            m_mergedFreeSlots.resize(m_freeSlots.size());
+            std::merge(m_freeSlots.begin(), freed, freed, m_freeSlots.end(), m_mergedFreeSlots.begin(), std::greater<uint32_t>());
+            m_freeSlots.swap(m_mergedFreeSlots);
+        }
+    }
+
+    CubeSample CubeController::evaluateCube(size_t index, float time) const
+    {
+        auto age = time - m_cubeStates.startTimes[index];
+        auto fadeOutAge = m_cubeStates.fadeOutTimes[index] - m_cubeStates.startTimes[index];
+
+        CubeSample sample;
+        sample.state = analyticState(age, fadeOutAge);
+        sample.opacity = analyticOpacity(age, fadeOutAge);
+        // Same evaluation as in updates, so the position matches the stored one exactly
+        sample.position = mapOntoHelixAt(m_cubeStates.helices, m_cubeStates.startTimes.data(), time, CUBE_HELIX_TIME_SCALE, index);
+        return sample;
     }
 }
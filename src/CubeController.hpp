@@ -1,14 +1,24 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 
 #include <glm/vec3.hpp>
 
 #include "Spiral.hpp"
 #include "GameTime.hpp"
+#include "WorkerPool.hpp"
+#include "DirtyRanges.hpp"
+#include "AlignedAllocator.hpp"
 
 namespace cubedemo
 {
+    // Radius of a sphere around the cube mesh at scale 1, centered on the cube position
+    const float CUBE_BOUNDING_RADIUS = 1.7320508f;
+
+    const float CUBE_FADE_SECONDS = 3.0f; // Duration of fading in and fading out
+    const float CUBE_HELIX_TIME_SCALE = 0.1f; // Helices are evaluated at this fraction of a cube's age
+
     // The states a cube can be in:
     // FadeIn - Just spawned, fading it in
     // Moving - Moving around
@@ -22,42 +32,132 @@ namespace cubedemo
         FadeOut,
     };
 
+    // How opacities and state transitions of cubes are computed:
+    // Integrated - Opacities are accumulated from the frame delta, and transitions are checked in every update
+    // Analytic - Opacities and states are closed-form functions of the time since the cube spawned,
+    //            so updates can skip any amount of time without changing the outcome
+    enum class CubeUpdateMode
+    {
+        Integrated,
+        Analytic,
+    };
+
+    // The state of a single cube at some point in time
+    struct CubeSample
+    {
+        CubeState state;
+        float opacity;
+        glm::vec3 position;
+    };
+
     // Contains per-cube state for a collection of cubes
     // This is saved as a structure-of-arrays instead of the usual array-of-structs
-    // to ease bulk data copying into GL buffers and for a slight (?) speed boost
+    // to ease bulk data copying into GL buffers and for a slight (?) speed boost.
+    // The arrays are cache line aligned, so they can be updated in chunks by several threads.
     struct CubeStates
     {
-        std::vector<CubeState> states; // The state each vector is in
-        std::vector<HelixData> helices; // Helix data for each cube
-        std::vector<glm::vec3> positions; // The center of each cube after applying any mapping and movement
-        std::vector<glm::vec3> rotationAxes; // Per-cube rotation axis
-        std::vector<float> rotationSpeeds; // Per-cube rotation speed
-        std::vector<float> opacities; // The opacity of each cube, used for fade in and fade out
-        std::vector<float> scales; // Adjusts the size of each cube
-        std::vector<float> startTimes; // Start time for helix curve mapping (in seconds)
+        AlignedVector<CubeState> states; // The state each vector is in
+        HelixArrays helices; // Helix data for each cube
+        AlignedVector<glm::vec3> positions; // The center of each cube after applying any mapping and movement
+        AlignedVector<glm::vec3> previousPositions; // Positions before the last update, for interpolation
+        AlignedVector<glm::vec3> rotationAxes; // Per-cube rotation axis
+        AlignedVector<float> rotationSpeeds; // Per-cube rotation speed
+        AlignedVector<float> opacities; // The opacity of each cube, used for fade in and fade out
+        AlignedVector<float> previousOpacities; // Opacities before the last update, for interpolation
+        AlignedVector<float> scales; // Adjusts the size of each cube
+        AlignedVector<float> startTimes; // Start time for helix curve mapping (in seconds)
+        AlignedVector<float> fadeOutTimes; // Time at which each cube starts to fade out (in seconds, infinite if never)
 
         CubeStates(int size);
     };
 
+    // Slots of cubes whose data changed, per group of CubeStates arrays.
+    // Only spawns are tracked, states and opacities change every frame and are built from the alive list instead.
+    struct CubeDirtyRanges
+    {
+        DirtyRanges spawned; // Spawned cubes, all of whose arrays changed
+
+        explicit CubeDirtyRanges(size_t maxRanges = DirtyRanges::DEFAULT_MAX_RANGES);
+
+        void clear();
+    };
+
     // Collects the state of a bunch of cubes, floating in space
     class CubeController
     {
+    public:
+        // Amount of cubes updated as one unit of work in parallel updates.
+        // A multiple of 16, so chunks of float and index arrays start on a new cache line.
+        static const size_t UPDATE_CHUNK_SIZE = 2048;
+
+        // Seed used for spawning cubes unless another one is given
+        static const uint64_t DEFAULT_SEED = 0x5eed0fc0be5ull;
+
     private:
         int m_cubeCount; // Amount of managed cubes
-        int m_aliveCubes; // Amount of currently alive cubes
         CubeStates m_cubeStates; // Per-cube state
 
+        // Slots are tracked explicitly, so spawning doesn't have to search for dead cubes
+        // and updates only touch living ones
+        std::vector<uint32_t> m_freeSlots; // Stack of dead cube slots, sorted so the lowest index is on top
+        std::vector<uint32_t> m_mergedFreeSlots; // Scratch space for merging freed slots into the stack
+        AlignedVector<uint32_t> m_aliveIndices; // Dense list of the slots of all living cubes
+
+        WorkerPool *m_workers; // Pool for parallel updates, or null to update on the calling thread
+        CubeUpdateMode m_updateMode; // How opacities and transitions are computed
+
+        uint64_t m_seed; // Seed for the random parameters of spawned cubes
+        uint64_t m_spawnSequence; // Total amount of cubes spawned so far
+
+        CubeDirtyRanges m_dirtyRanges; // Changes since the last call to clearDirtyRanges
+
+        // Run function on [0, count) in chunks of UPDATE_CHUNK_SIZE, in parallel if possible
+        void forEachRange(size_t count, const WorkerPool::RangeFunction& function);
+        void spawnRange(const GameTimePoint& time, size_t begin, size_t end, uint64_t firstSequence); // Spawn the cubes in m_aliveIndices[begin, end)
+        void updateRangeIntegrated(const GameTimePoint& time, size_t begin, size_t end); // Update the cubes in m_aliveIndices[begin, end)
+        void updateRangeAnalytic(const GameTimePoint& time, size_t begin, size_t end); // Same, using CubeUpdateMode::Analytic
+
     public:
-        CubeController(int count);
+        // Cubes spawned by controllers with the same count and seed follow the same paths,
+        // regardless of the amount of worker threads
+        CubeController(int count, uint64_t seed = DEFAULT_SEED);
+
+        // Update cubes on the given pool from now on (null to go back to single-threaded updates).
+        // The pool must outlive the controller or be detached before being destroyed.
+        inline void setWorkerPool(WorkerPool *workers) { m_workers = workers; }
+        inline WorkerPool* workerPool() const { return m_workers; }
+
+        inline CubeUpdateMode updateMode() const { return m_updateMode; }
+        inline void setUpdateMode(CubeUpdateMode mode) { m_updateMode = mode; }
 
         inline size_t count() const { return m_cubeCount; }
+        inline size_t aliveCount() const { return m_aliveIndices.size(); }
+        inline const uint32_t* aliveIndices() const { return m_aliveIndices.data(); } // Slots of all cubes that aren't dead, in no particular order
         inline const CubeState* cubeStates() const { return m_cubeStates.states.data(); }
         inline const glm::vec3* cubePositions() const { return m_cubeStates.positions.data(); }
+        inline const glm::vec3* cubePreviousPositions() const { return m_cubeStates.previousPositions.data(); }
         inline const glm::vec3* cubeRotationAxes() const { return m_cubeStates.rotationAxes.data(); }
         inline const float* cubeRotationSpeeds() const { return m_cubeStates.rotationSpeeds.data(); }
         inline const float* cubeOpacities() const { return m_cubeStates.opacities.data(); }
+        inline const float* cubePreviousOpacities() const { return m_cubeStates.previousOpacities.data(); }
         inline const float* cubeScales() const { return m_cubeStates.scales.data(); }
+        inline const float* cubeStartTimes() const { return m_cubeStates.startTimes.data(); }
+        inline const float* cubeFadeOutTimes() const { return m_cubeStates.fadeOutTimes.data(); }
+        inline HelixData cubeHelix(size_t index) const { return m_cubeStates.helices.get(index); }
 
         void update(const GameTimePoint& time); // Update the state of each cube
+
+        // Slots whose data changed since the dirty ranges were last cleared, for keeping copies of the arrays up to date.
+        // Changes accumulate over any number of updates, whoever consumes them clears them afterwards.
+        inline const CubeDirtyRanges& dirtyRanges() const { return m_dirtyRanges; }
+        inline void clearDirtyRanges() { m_dirtyRanges.clear(); }
+
+        // The amount of cubes that should be alive at the given time, out of maxCubes
+        static int aliveCubesForTime(const GameTimePoint& time, int maxCubes);
+
+        // Evaluate the cube in the given slot at any time (in seconds) during its current life,
+        // without touching the stored state. Uses the closed-form solution of CubeUpdateMode::Analytic,
+        // so this works for times between updates, or for only evaluating cubes that are actually needed.
+        CubeSample evaluateCube(size_t index, float time) const;
     };
 }
@@ -0,0 +1,373 @@
+#include "CubeFrame.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Util.hpp"
+#include "Frustum.hpp"
+
+namespace cubedemo
+{
+    // Fade out ages beyond this (in seconds) are never reached, and stand in for cubes that never fade out
+    static const float MAX_FADE_OUT_AGE = 1e9f;
+
+    // Spawned slots at most this far apart are uploaded together
+    static const uint32_t SLOT_UPLOAD_GAP = 16;
+
+    static const size_t ARENA_PADDING = 4 * CACHE_LINE_SIZE; // Alignment of the arrays in an arena
+
+    // Search sorted pairs by key
+    static bool keyLess(const RadixPair& pair, uint32_t key)
+    {
+        return pair.key < key;
+    }
+
+    size_t instanceRecordSize(InstanceFormat format, CubeOrdering ordering)
+    {
+        switch (format)
+        {
+        case InstanceFormat::Compact16:
+            return sizeof(CompactCubeInstance);
+        case InstanceFormat::StaticRotation:
+            return sizeof(PositionCubeInstance);
+        case InstanceFormat::GpuHelix:
+            return ordering == CubeOrdering::Depth ? sizeof(uint32_t) : 0;
+        default:
+            return sizeof(CubeInstance);
+        }
+    }
+
+    size_t slotTexels(InstanceFormat format)
+    {
+        switch (format)
+        {
+        case InstanceFormat::StaticRotation:
+            return 1;
+        case InstanceFormat::GpuHelix:
+            return 3;
+        default:
+            return 0;
+        }
+    }
+
+    // // //
+    // CubeFrame implementation
+    // // //
+
+    CubeFrame::CubeFrame()
+        : drawCount{ 0 }, opaqueCount{ 0 }, drawRanges{}, drawRangeCount{ 0 }, instances{ nullptr }, instanceOrigin{ 0.0f }, instanceExtent{ 1.0f },
+        allSlots{ false }, slotData{ nullptr }
+    {
+    }
+
+    // // //
+    // CubeFrameBuilder implementation
+    // // //
+
+    CubeFrameBuilder::CubeFrameBuilder(InstanceFormat format, CubeOrdering ordering)
+        : m_format{ format }, m_ordering{ ordering }, m_slotsBuilt{ false }, m_usedSlots{ 0 }
+    {
+    }
+
+    size_t CubeFrameBuilder::collectVisibleCubes(const CubeController& cubes, float alpha, const glm::mat4& viewProjection, size_t& opaqueCount)
+    {
+        // Only living cubes are considered, and of those only ones that are visible at all and whose
+        // bounding spheres intersect the view frustum
+        Frustum frustum{ viewProjection };
+
+        auto positionSource = cubes.cubePositions();
+        auto previousPositionSource = cubes.cubePreviousPositions();
+        auto opacitySource = cubes.cubeOpacities();
+        auto previousOpacitySource = cubes.cubePreviousOpacities();
+        auto scaleSource = cubes.cubeScales();
+        auto aliveIndices = cubes.aliveIndices();
+        auto pairs = m_sorter.pairs();
+        auto sorted = m_ordering == CubeOrdering::Depth;
+
+        // View depth is the clip space w, and translucent cubes are marked by a negative depth until sorting.
+        // The y row of the view projection has the length of the vertical focal scale, which turns the ratio
+        // of a radius to its depth into a fraction of the height of the view.
+        auto depthRow = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        auto sizeScale = CUBE_BOUNDING_RADIUS * glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]));
+        auto depths = sorted ? m_scratch.allocateArray<float>(cubes.aliveCount()) : nullptr;
+        auto minDepth = std::numeric_limits<float>::max();
+        auto maxDepth = 0.0f;
+
+        size_t count = 0;
+        for (size_t k = 0; k < cubes.aliveCount(); k++)
+        {
+            auto i = aliveIndices[k];
+
+            // Interpolate between the last two simulation steps.
+            // Cubes that just spawned haven't started to fade in yet.
+            auto opacity = glm::mix(previousOpacitySource[i], opacitySource[i], alpha);
+            if (opacity <= 0.0f)
+                continue;
+            auto position = glm::mix(previousPositionSource[i], positionSource[i], alpha);
+            if (!frustum.intersectsSphere(position, std::abs(scaleSource[i]) * CUBE_BOUNDING_RADIUS))
+                continue;
+
+            // Cubes at the near plane or behind it count as nearly infinitely large
+            auto depth = std::max(std::numeric_limits<float>::min(), glm::dot(depthRow, glm::vec4(position, 1.0f)));
+            pairs[count].key = uint32_t(cubeMeshLod(sizeScale * std::abs(scaleSource[i]) / depth));
+            if (sorted)
+            {
+                minDepth = std::min(minDepth, depth);
+                maxDepth = std::max(maxDepth, depth);
+                depths[count] = opacity < 1.0f ? -depth : depth;
+            }
+            pairs[count++].value = i;
+        }
+
+        opaqueCount = 0;
+        if (count == 0)
+            return count;
+        if (!sorted)
+        {
+            // Only group the cubes by level of detail
+            m_sorter.sort(count, LOD_KEY_BITS);
+            return count;
+        }
+
+        // Opaque cubes get keys counting up with level of detail, then depth.
+        // Translucent ones get the top bit, and keys counting down with depth alone, so they blend in the right order.
+        // Their level of detail goes into the lowest bits, which only order cubes at the same depth.
+        static const uint32_t MAX_DEPTH_KEY = (1u << DEPTH_KEY_BITS) - 1;
+        static const uint32_t TRANSLUCENT_KEY = 1u << (LOD_KEY_BITS + DEPTH_KEY_BITS);
+        static_assert(CUBE_MESH_LODS <= 1u << LOD_KEY_BITS, "Levels of detail must fit into their bits of the sort keys");
+        // All cubes at the same depth, like a single one, share the nearest depth key
+        auto depthRange = maxDepth - minDepth;
+        auto depthScale = depthRange > 0.0f ? float(MAX_DEPTH_KEY) / depthRange : 0.0f;
+        for (size_t n = 0; n < count; n++)
+        {
+            auto depthKey = std::min(MAX_DEPTH_KEY, uint32_t((std::abs(depths[n]) - minDepth) * depthScale));
+            auto lod = pairs[n].key;
+            pairs[n].key = depths[n] < 0.0f
+                ? TRANSLUCENT_KEY | ((MAX_DEPTH_KEY - depthKey) << LOD_KEY_BITS) | lod
+                : (lod << DEPTH_KEY_BITS) | depthKey;
+        }
+        m_sorter.sort(count, LOD_KEY_BITS + DEPTH_KEY_BITS + 1);
+
+        // Sorting swaps buffers with every pass it doesn't skip, the sorted pairs may have moved
+        pairs = m_sorter.pairs();
+        opaqueCount = size_t(std::lower_bound(pairs, pairs + count, TRANSLUCENT_KEY, keyLess) - pairs);
+        return count;
+    }
+
+    void CubeFrameBuilder::findDrawRanges(size_t count, CubeFrame& frame) const
+    {
+        auto pairs = m_sorter.pairs();
+        frame.drawRangeCount = 0;
+
+        // Sorted opaque keys start with the level of detail, as do all keys with CubeOrdering::Slot.
+        // Every level of detail that occurs is one draw range.
+        auto opaqueEnd = m_ordering == CubeOrdering::Depth ? frame.opaqueCount : count;
+        auto shift = m_ordering == CubeOrdering::Depth ? DEPTH_KEY_BITS : 0;
+        auto first = pairs;
+        for (uint32_t lod = 0; lod < CUBE_MESH_LODS && first != pairs + opaqueEnd; lod++)
+        {
+            auto last = std::lower_bound(first, pairs + opaqueEnd, (lod + 1) << shift, keyLess);
+            if (last != first)
+                frame.drawRanges[frame.drawRangeCount++] = CubeDrawRange{ size_t(first - pairs), size_t(last - first), lod, false };
+            first = last;
+        }
+
+        // Translucent cubes are in depth order, every run of one level of detail is a draw range.
+        // Once there are MAX_DRAW_RANGES, the last one takes the rest at the most detailed level any of them needs.
+        static const uint32_t LOD_KEY_MASK = (1u << LOD_KEY_BITS) - 1;
+        for (auto n = opaqueEnd; n < count; n++)
+        {
+            auto lod = size_t(pairs[n].key & LOD_KEY_MASK);
+            auto previous = n > opaqueEnd ? &frame.drawRanges[frame.drawRangeCount - 1] : nullptr;
+            if (previous != nullptr && (previous->lod == lod || frame.drawRangeCount == CubeFrame::MAX_DRAW_RANGES))
+            {
+                previous->lod = std::min(previous->lod, lod);
+                previous->count++;
+            }
+            else
+                frame.drawRanges[frame.drawRangeCount++] = CubeDrawRange{ n, 1, lod, true };
+        }
+    }
+
+    template<typename Emit>
+    void CubeFrameBuilder::forEachCollectedCube(const CubeController& cubes, float alpha, size_t count, const Emit& emit) const
+    {
+        auto positionSource = cubes.cubePositions();
+        auto previousPositionSource = cubes.cubePreviousPositions();
+        auto opacitySource = cubes.cubeOpacities();
+        auto previousOpacitySource = cubes.cubePreviousOpacities();
+        auto pairs = m_sorter.pairs();
+        for (size_t n = 0; n < count; n++)
+        {
+            auto i = pairs[n].value;
+            auto opacity = glm::mix(previousOpacitySource[i], opacitySource[i], alpha);
+            auto position = glm::mix(previousPositionSource[i], positionSource[i], alpha);
+            emit(n, i, position, opacity);
+        }
+    }
+
+    void CubeFrameBuilder::writeInstances(const GameTimePoint& time, const CubeController& cubes, float alpha, size_t count, CubeInstance *out) const
+    {
+        auto scaleSource = cubes.cubeScales();
+        auto rotationAxisSource = cubes.cubeRotationAxes();
+        auto rotationSpeedSource = cubes.cubeRotationSpeeds();
+        forEachCollectedCube(cubes, alpha, count, [&](size_t n, uint32_t i, const glm::vec3& position, float opacity)
+        {
+            // process axis, rotation speed, and time into quaternion rotations.
+            // q and -q are the same rotation, so w can be kept positive and left out.
+            float angle = time.total() * rotationSpeedSource[i];
+            auto rotation = glm::angleAxis(angle, rotationAxisSource[i]);
+            auto sign = rotation.w < 0.0f ? -1.0f : 1.0f;
+
+            out[n].positionScale = glm::vec4(position, scaleSource[i]);
+            out[n].rotationOpacity = glm::vec4(sign * rotation.x, sign * rotation.y, sign * rotation.z, opacity);
+        });
+    }
+
+    void CubeFrameBuilder::writeInstances(const CubeController& cubes, float alpha, size_t count, PositionCubeInstance *out) const
+    {
+        forEachCollectedCube(cubes, alpha, count, [&](size_t n, uint32_t i, const glm::vec3& position, float opacity)
+        {
+            out[n].position = position;
+            out[n].slotOpacity = packSlotOpacity(i, opacity);
+        });
+    }
+
+    void CubeFrameBuilder::writeSlot(const CubeController& cubes, uint32_t slot, glm::vec4 *out) const
+    {
+        auto spin = glm::vec4(cubes.cubeRotationAxes()[slot] * cubes.cubeRotationSpeeds()[slot], cubes.cubeScales()[slot]);
+        if (m_format != InstanceFormat::GpuHelix)
+        {
+            out[0] = spin;
+            return;
+        }
+
+        // Cubes that never sink have an infinite fade out time, keep the shader math finite
+        auto helix = cubes.cubeHelix(slot);
+        auto startTime = cubes.cubeStartTimes()[slot];
+        auto fadeOutAge = std::min(cubes.cubeFadeOutTimes()[slot] - startTime, MAX_FADE_OUT_AGE);
+        out[0] = glm::vec4(helix.position, helix.r);
+        out[1] = glm::vec4(helix.h, helix.t0, startTime, fadeOutAge);
+        out[2] = spin;
+    }
+
+    void CubeFrameBuilder::buildSlots(const CubeController& cubes, CubeFrame& frame)
+    {
+        auto maxRanges = cubes.dirtyRanges().spawned.maxRanges() + 1;
+        if (frame.slotRanges.capacity() < maxRanges)
+            frame.slotRanges.reserve(maxRanges);
+
+        if (!m_slotsBuilt)
+        {
+            // First frame: write all slots
+            frame.allSlots = true;
+            frame.slotRanges.assign(1, DirtyRanges::Range{ 0, uint32_t(cubes.count()) });
+            m_slotsBuilt = true;
+
+            auto aliveIndices = cubes.aliveIndices();
+            for (size_t k = 0; k < cubes.aliveCount(); k++)
+                m_usedSlots = std::max(m_usedSlots, size_t(aliveIndices[k]) + 1);
+        }
+        else
+        {
+            // Slot data only changes when cubes spawn. Gaps between spawned slots are rewritten as well,
+            // their data is still up to date, and one larger upload is cheaper than several small ones.
+            cubes.dirtyRanges().spawned.merged(SLOT_UPLOAD_GAP, frame.slotRanges);
+            if (!frame.slotRanges.empty())
+                m_usedSlots = std::max(m_usedSlots, size_t(frame.slotRanges.back().end));
+        }
+
+        size_t slotCount = 0;
+        for (const auto& range : frame.slotRanges)
+            slotCount += range.end - range.begin;
+
+        auto texels = slotTexels(m_format);
+        auto out = frame.arena.allocateArray<glm::vec4>(slotCount * texels);
+        frame.slotData = out;
+        for (const auto& range : frame.slotRanges)
+        {
+            for (auto i = range.begin; i < range.end; i++, out += texels)
+                writeSlot(cubes, i, out);
+        }
+    }
+
+    void CubeFrameBuilder::build(const GameTimePoint& time, const CubeController& cubes, float alpha, const glm::mat4& viewProjection, CubeFrame& frame)
+    {
+        // Storage for the worst case of every cube being visible and every slot changing, so nothing grows after the first frame
+        auto recordSize = instanceRecordSize(m_format, m_ordering);
+        frame.arena.reset();
+        frame.arena.reserve((recordSize + sizeof(glm::vec4) * slotTexels(m_format)) * cubes.count() + ARENA_PADDING);
+        m_scratch.reset();
+        m_scratch.reserve((sizeof(CubeInstance) + sizeof(float)) * cubes.count() + ARENA_PADDING);
+        m_sorter.reserve(cubes.count());
+
+        frame.time = time;
+        frame.drawCount = 0;
+        frame.opaqueCount = 0;
+        frame.drawRangeCount = 0;
+        frame.instances = nullptr;
+        frame.allSlots = false;
+        frame.slotRanges.clear();
+        frame.slotData = nullptr;
+        if (slotTexels(m_format) > 0)
+            buildSlots(cubes, frame);
+
+        if (m_format == InstanceFormat::GpuHelix && m_ordering == CubeOrdering::Slot)
+        {
+            // The shader evaluates every slot that was ever used, there is no per-frame data
+            frame.drawCount = m_usedSlots;
+            if (m_usedSlots > 0)
+                frame.drawRanges[frame.drawRangeCount++] = CubeDrawRange{ 0, m_usedSlots, 0, false };
+            return;
+        }
+
+        auto count = collectVisibleCubes(cubes, alpha, viewProjection, frame.opaqueCount);
+        frame.drawCount = count;
+        findDrawRanges(count, frame);
+        switch (m_format)
+        {
+        case InstanceFormat::GpuHelix:
+        {
+            // The shader evaluates the motion of the given slots
+            auto slots = frame.arena.allocateArray<uint32_t>(count);
+            auto pairs = m_sorter.pairs();
+            for (size_t n = 0; n < count; n++)
+                slots[n] = pairs[n].value;
+            frame.instances = slots;
+            break;
+        }
+        case InstanceFormat::StaticRotation:
+        {
+            CC_ASSERT(cubes.count() <= MAX_INSTANCE_SLOT + 1)
+            auto instances = frame.arena.allocateArray<PositionCubeInstance>(count);
+            writeInstances(cubes, alpha, count, instances);
+            frame.instances = instances;
+            break;
+        }
+        case InstanceFormat::Compact16:
+        {
+            // Quantization needs the bounds of all visible cubes, so write full instances first
+            auto unpacked = m_scratch.allocateArray<CubeInstance>(count);
+            writeInstances(time, cubes, alpha, count, unpacked);
+            instanceBounds(unpacked, count, frame.instanceOrigin, frame.instanceExtent);
+
+            auto packed = frame.arena.allocateArray<CompactCubeInstance>(count);
+            packCompactInstances(unpacked, count, frame.instanceOrigin, frame.instanceExtent, packed);
+            frame.instances = packed;
+            break;
+        }
+        default:
+        {
+            auto instances = frame.arena.allocateArray<CubeInstance>(count);
+            writeInstances(time, cubes, alpha, count, instances);
+            frame.instances = instances;
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "GameTime.hpp"
+#include "NonCopyable.hpp"
+#include "DirtyRanges.hpp"
+#include "FrameArena.hpp"
+#include "WorkerPool.hpp"
+#include "RadixSort.hpp"
+#include "CubeController.hpp"
+#include "CubeMesh.hpp"
+#include "InstancePacking.hpp"
+
+namespace cubedemo
+{
+    // How instance data is stored on the GPU:
+    // Float32 - CubeInstance, 32 bytes per cube
+    // Compact16 - CompactCubeInstance, 16 bytes per cube, quantized after culling
+    // StaticRotation - PositionCubeInstance, 16 bytes per cube. Rotation axes, speeds and scales are only
+    //                  uploaded when cubes spawn, and the vertex shader computes the rotation at the current time.
+    // GpuHelix - Nothing per frame. Helices, start and fade out times are uploaded when cubes spawn, and
+    //            the vertex shader evaluates the motion and opacity of every slot. Nothing is culled.
+    enum class InstanceFormat
+    {
+        Float32,
+        Compact16,
+        StaticRotation,
+        GpuHelix,
+    };
+
+    // Order in which cubes are drawn:
+    // Slot - In slot order, as the cubes happen to be stored, grouped by level of detail
+    // Depth - Fully opaque cubes front to back to save overdraw, then translucent cubes back to front so they blend correctly.
+    //         Opaque cubes are grouped by level of detail first, translucent ones are only split where it changes.
+    //         InstanceFormat::GpuHelix then gets per-frame instance data as well, the slots of the visible cubes in order.
+    enum class CubeOrdering
+    {
+        Slot,
+        Depth,
+    };
+
+    size_t instanceRecordSize(InstanceFormat format, CubeOrdering ordering); // Bytes per instance, 0 if there is no per-frame instance data
+    size_t slotTexels(InstanceFormat format); // RGBA32F texels of per-slot data, 0 if there is none
+
+    // A range of instances drawn with one level of detail of the cube mesh
+    struct CubeDrawRange
+    {
+        size_t first; // Index of the first instance
+        size_t count;
+        size_t lod; // Level of detail, see cubeMeshLods
+        bool translucent; // Drawn after all opaque ranges, with CubeOrdering::Depth
+    };
+
+    // Everything CubeRenderer uploads for one frame, built from the cubes without touching GL,
+    // so it can be built on another thread while the previous frame is drawn
+    struct CubeFrame : NonCopyable
+    {
+        GameTimePoint time; // Time the frame shows
+        size_t drawCount; // Amount of instances to draw
+        size_t opaqueCount; // The first opaqueCount instances are fully opaque, with CubeOrdering::Depth
+
+        // Instances grouped by level of detail, in drawing order. InstanceFormat::GpuHelix with CubeOrdering::Slot
+        // has no per-frame data to group cubes by, so every slot is drawn at full detail.
+        // Translucent cubes can't be regrouped without breaking their depth order, they get up to
+        // MAX_TRANSLUCENT_DRAW_RANGES ranges of their own.
+        static const size_t MAX_TRANSLUCENT_DRAW_RANGES = 32;
+        static const size_t MAX_DRAW_RANGES = CUBE_MESH_LODS + MAX_TRANSLUCENT_DRAW_RANGES;
+        CubeDrawRange drawRanges[MAX_DRAW_RANGES];
+        size_t drawRangeCount;
+
+        // Per-frame instance records
+        const void *instances; // instanceRecordSize() bytes for each of the drawCount instances, or null
+        glm::vec3 instanceOrigin; // Bounds of the quantized positions, for InstanceFormat::Compact16
+        glm::vec3 instanceExtent;
+
+        // Per-slot data that changed since the last frame
+        bool allSlots; // Whether slotRanges covers every slot, and the slot buffer has to be reallocated
+        std::vector<DirtyRanges::Range> slotRanges; // Sorted, disjoint ranges of changed slots
+        const glm::vec4 *slotData; // slotTexels() texels for each slot in slotRanges, in order
+
+        FrameArena arena; // Storage for instances and slotData
+
+        CubeFrame();
+    };
+
+    // Builds CubeFrames for a given instance format. Keeps track of what previous frames contained,
+    // so frames have to be uploaded in the order they were built.
+    class CubeFrameBuilder : NonCopyable
+    {
+    private:
+        // View depths are sorted as fixed point numbers between the nearest and farthest visible cube,
+        // with the level of detail and one more bit to put translucent cubes after opaque ones.
+        // Keys fit into 22 bits, which the sorter covers in three passes.
+        static const uint32_t DEPTH_KEY_BITS = 19;
+        static const uint32_t LOD_KEY_BITS = 2;
+
+        InstanceFormat m_format;
+        CubeOrdering m_ordering;
+        bool m_slotsBuilt; // Whether all slots have been written into a frame
+        size_t m_usedSlots; // Slots above this have never been used
+        RadixSorter m_sorter; // Slots of the drawn cubes in the values of its pairs, sorted by depth with CubeOrdering::Depth
+        FrameArena m_scratch; // Memory only needed while building a frame
+
+        // Put the slots of all cubes that need to be drawn into the values of m_sorter.pairs(), in drawing order.
+        // Returns their count, and the count of fully opaque cubes among them with CubeOrdering::Depth.
+        size_t collectVisibleCubes(const CubeController& cubes, float alpha, const glm::mat4& viewProjection, size_t& opaqueCount);
+
+        // Find the draw ranges of the first count collected cubes from their sorted keys
+        void findDrawRanges(size_t count, CubeFrame& frame) const;
+
+        // Call emit(index, slot, position, opacity) for the first count collected cubes
+        template<typename Emit>
+        void forEachCollectedCube(const CubeController& cubes, float alpha, size_t count, const Emit& emit) const;
+
+        // Write the instance data of the first count collected cubes
+        void writeInstances(const GameTimePoint& time, const CubeController& cubes, float alpha, size_t count, CubeInstance *out) const;
+        void writeInstances(const CubeController& cubes, float alpha, size_t count, PositionCubeInstance *out) const;
+
+        void writeSlot(const CubeController& cubes, uint32_t slot, glm::vec4 *out) const; // Write the per-slot data of one cube
+        void buildSlots(const CubeController& cubes, CubeFrame& frame); // Write the per-slot data of cubes spawned since the dirty ranges were cleared
+
+    public:
+        explicit CubeFrameBuilder(InstanceFormat format, CubeOrdering ordering = CubeOrdering::Slot);
+
+        inline InstanceFormat format() const { return m_format; }
+        inline CubeOrdering ordering() const { return m_ordering; }
+
+        // Sort on the given pool from now on (null to go back to single-threaded sorts)
+        inline void setWorkerPool(WorkerPool *workers) { m_sorter.setWorkerPool(workers); }
+
+        // Build a frame showing the cubes at the given time. alpha interpolates between the previous (0)
+        // and the latest (1) cube states, and cubes outside the view frustum are culled.
+        // Uses the dirty ranges of the cubes, which should be cleared afterwards.
+        void build(const GameTimePoint& time, const CubeController& cubes, float alpha, const glm::mat4& viewProjection, CubeFrame& frame);
+    };
+}
@@ -0,0 +1,108 @@
+#include "CubeMesh.hpp"
+
+#include <map>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    // Segments around the rounded edges of each generated level of detail, after the authored mesh
+    static const int LOD_EDGE_SEGMENTS[CUBE_MESH_LODS - 1] = { 1, 0 };
+
+    // Cubes whose projected size is below LOD_SCREEN_SIZES[n] use level of detail n + 1 or coarser.
+    // The rounding of the edges covers about 6% of a cube, so it's only a pixel or two wide at these sizes.
+    static const float LOD_SCREEN_SIZES[CUBE_MESH_LODS - 1] = { 0.04f, 0.01f };
+
+    Mesh generateRoundedCube(int segments, float radius)
+    {
+        CC_ASSERT(segments >= 0 && radius >= 0.0f && radius <= 1.0f)
+
+        // Coordinates of the vertices along each axis of a face: the flat part, and steps of equal angles
+        // around the rounded edges on either side. Zero segments leave no room for rounding.
+        auto inner = segments > 0 ? 1.0f - radius : 1.0f;
+        std::vector<float> grid;
+        for (auto k = segments; k > 0; k--)
+            grid.push_back(-(inner + radius * std::tan(k * glm::quarter_pi<float>() / segments)));
+        grid.push_back(-inner);
+        grid.push_back(inner);
+        for (auto k = 1; k <= segments; k++)
+            grid.push_back(inner + radius * std::tan(k * glm::quarter_pi<float>() / segments));
+        grid.front() = -1.0f; // tan(pi / 4) isn't exactly 1 in floats, edges must match exactly
+        grid.back() = 1.0f;
+
+        // Points on the surface of a box are pushed out from the inner box by the radius.
+        // Faces share the points on their edges, which are welded into one vertex if their normals match.
+        Mesh mesh;
+        std::map<std::array<float, 6>, uint32_t> vertices;
+        auto vertex = [&](const glm::vec3& point, const glm::vec3& faceNormal)
+        {
+            auto innerPoint = glm::clamp(point, glm::vec3(-inner), glm::vec3(inner));
+            auto normal = segments > 0 ? glm::normalize(point - innerPoint) : faceNormal;
+            std::array<float, 6> key{ { point.x, point.y, point.z, normal.x, normal.y, normal.z } };
+            auto found = vertices.find(key);
+            if (found != vertices.end())
+                return found->second;
+
+            auto index = uint32_t(mesh.positions.size());
+            mesh.positions.push_back(segments > 0 ? innerPoint + radius * normal : point);
+            mesh.normals.push_back(normal);
+            vertices.emplace(key, index);
+            return index;
+        };
+
+        auto size = grid.size();
+        for (auto axis = 0; axis < 3; axis++)
+        {
+            for (auto sign = -1; sign <= 1; sign += 2)
+            {
+                // u cross v points along the face normal, flipped for negative faces to keep the winding
+                glm::vec3 normal{ 0.0f }, u{ 0.0f }, v{ 0.0f };
+                normal[axis] = float(sign);
+                u[(axis + 1) % 3] = float(sign);
+                v[(axis + 2) % 3] = 1.0f;
+
+                auto first = mesh.indices.size();
+                std::vector<uint32_t> face(size * size);
+                for (size_t j = 0; j < size; j++)
+                {
+                    for (size_t i = 0; i < size; i++)
+                        face[j * size + i] = vertex(normal + grid[i] * u + grid[j] * v, normal);
+                }
+                for (size_t j = 0; j + 1 < size; j++)
+                {
+                    for (size_t i = 0; i + 1 < size; i++)
+                    {
+                        auto a = face[j * size + i], b = face[j * size + i + 1];
+                        auto c = face[(j + 1) * size + i + 1], d = face[(j + 1) * size + i];
+                        mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+                    }
+                }
+                CC_ASSERT(mesh.indices.size() - first == 6 * (size - 1) * (size - 1))
+            }
+        }
+        return mesh;
+    }
+
+    std::vector<Mesh> cubeMeshLods(const Mesh& authored)
+    {
+        std::vector<Mesh> lods{ authored };
+        for (auto segments : LOD_EDGE_SEGMENTS)
+            lods.push_back(generateRoundedCube(segments, CUBE_MESH_EDGE_RADIUS));
+        return lods;
+    }
+
+    size_t cubeMeshLod(float projectedSize)
+    {
+        size_t lod = 0;
+        while (lod < CUBE_MESH_LODS - 1 && projectedSize < LOD_SCREEN_SIZES[lod])
+            lod++;
+        return lod;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+namespace cubedemo
+{
+    // Levels of detail of the cube mesh, from the authored rounded cube (0) down to a plain box
+    const size_t CUBE_MESH_LODS = 3;
+
+    // Radius of the rounded edges and corners of the cube mesh, whose flat faces are at +-1
+    const float CUBE_MESH_EDGE_RADIUS = 0.125939f;
+
+    // An indexed triangle list with one normal per vertex, front faces wound counter-clockwise
+    struct Mesh
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<uint32_t> indices;
+    };
+
+    // Generate a cube spanning [-1, 1] with edges and corners rounded off with the given radius,
+    // using segments quads around each edge. Zero segments give a box of 12 triangles with flat normals.
+    Mesh generateRoundedCube(int segments, float radius);
+
+    // All levels of detail of the cube mesh, starting with the given authored rounded cube,
+    // followed by generated ones with less and less detail
+    std::vector<Mesh> cubeMeshLods(const Mesh& authored);
+
+    // The level of detail for a cube whose bounding sphere has the given projected diameter,
+    // as a fraction of the height of the view
+    size_t cubeMeshLod(float projectedSize);
+}
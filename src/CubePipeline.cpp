@@ -0,0 +1,92 @@
+#include "CubePipeline.hpp"
+
+#include <chrono>
+
+#include "Util.hpp"
+#include "AllocationCounter.hpp"
+
+namespace cubedemo
+{
+    static const int SPIN_WAIT_YIELDS = 64; // Yield this often before sleeping while waiting for the other thread
+    static const auto WAIT_SLEEP = std::chrono::microseconds(100);
+    static const uint64_t WARMUP_FRAMES = 60; // Frames built before checking that building doesn't allocate anymore
+
+    // Wait until a condition set by the other thread holds
+    template<typename Condition>
+    static void waitUntil(const Condition& condition)
+    {
+        for (auto i = 0; !condition(); i++)
+        {
+            if (i < SPIN_WAIT_YIELDS)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(WAIT_SLEEP);
+        }
+    }
+
+    CubePipeline::CubePipeline(CubeController& cubes, InstanceFormat format, CubeOrdering ordering, float simulationRate)
+        : m_cubes(cubes), m_timestep{ simulationRate }, m_builder{ format, ordering },
+        m_requested{ 0 }, m_built{ 0 }, m_stopping{ false }
+    {
+        m_builder.setWorkerPool(cubes.workerPool()); // The pool is only used by the simulation thread from now on
+        m_thread = std::thread{ &CubePipeline::threadMain, this };
+    }
+
+    CubePipeline::~CubePipeline()
+    {
+        m_stopping.store(true, std::memory_order_release);
+        m_thread.join();
+    }
+
+    void CubePipeline::request(const GameTimePoint& time, const glm::mat4& viewProjection)
+    {
+        // The simulation thread only reads the parameters after seeing the new request count
+        m_requestTime = time;
+        m_requestViewProjection = viewProjection;
+        m_requested.fetch_add(1, std::memory_order_release);
+    }
+
+    const CubeFrame& CubePipeline::nextFrame(const GameTimePoint& time, const glm::mat4& viewProjection)
+    {
+        if (m_requested.load(std::memory_order_relaxed) == 0)
+            request(time, viewProjection);
+
+        auto requested = m_requested.load(std::memory_order_relaxed);
+        waitUntil([&]() { return m_built.load(std::memory_order_acquire) == requested; });
+
+        // The simulation thread is idle now. It builds the next frame into the other buffer,
+        // while this one is uploaded.
+        auto& frame = m_frames[(requested - 1) % 2];
+        request(time, viewProjection);
+        return frame;
+    }
+
+    void CubePipeline::threadMain()
+    {
+        uint64_t built = 0;
+        while (true)
+        {
+            waitUntil([&]()
+            {
+                return m_requested.load(std::memory_order_acquire) > built || m_stopping.load(std::memory_order_acquire);
+            });
+            if (m_stopping.load(std::memory_order_acquire))
+                break;
+
+            // Run as many simulation steps as needed to catch up with the frame.
+            // Only this thread's allocations are checked, updates on the worker pool aren't covered.
+            auto allocationsBefore = allocationCount();
+            m_timestep.beginFrame(m_requestTime);
+            GameTimePoint stepTime;
+            while (m_timestep.nextStep(stepTime))
+                m_cubes.update(stepTime);
+
+            m_builder.build(m_timestep.interpolatedTime(), m_cubes, m_timestep.alpha(), m_requestViewProjection, m_frames[built % 2]);
+            m_cubes.clearDirtyRanges(); // The frame has picked up all changes
+            if (built >= WARMUP_FRAMES)
+                CC_ASSERT(allocationCount() == allocationsBefore)
+
+            m_built.store(++built, std::memory_order_release);
+        }
+    }
+}
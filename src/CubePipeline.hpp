@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+#include <glm/mat4x4.hpp>
+
+#include "GameTime.hpp"
+#include "NonCopyable.hpp"
+#include "CubeController.hpp"
+#include "CubeFrame.hpp"
+
+namespace cubedemo
+{
+    // Runs the cube simulation and builds CubeFrames on a thread of its own, so the simulation
+    // of the next frame overlaps with uploading and drawing the current one.
+    //
+    // Frames are double buffered: while the caller uploads one frame, the simulation thread builds
+    // the other. Requests and finished frames are handed off through two counters, without locks.
+    // The cubes belong to the simulation thread for the lifetime of the pipeline.
+    class CubePipeline : NonCopyable
+    {
+    private:
+        CubeController& m_cubes;
+        FixedTimestep m_timestep;
+        CubeFrameBuilder m_builder;
+        CubeFrame m_frames[2]; // Frame n is built into m_frames[n % 2]
+
+        std::atomic<uint64_t> m_requested; // Amount of frames requested by the caller
+        std::atomic<uint64_t> m_built; // Amount of frames finished by the simulation thread
+        std::atomic<bool> m_stopping;
+
+        // Parameters of the latest request, only written while no frame is being built
+        GameTimePoint m_requestTime;
+        glm::mat4 m_requestViewProjection;
+
+        std::thread m_thread;
+
+        void request(const GameTimePoint& time, const glm::mat4& viewProjection);
+        void threadMain();
+
+    public:
+        // cubes: Simulated with the given amount of steps per second, and only touched by the simulation thread from now on
+        // format, ordering: Instance format and ordering of the renderer the frames are uploaded to
+        CubePipeline(CubeController& cubes, InstanceFormat format, CubeOrdering ordering, float simulationRate);
+        ~CubePipeline();
+
+        // Start building the frame for the given time and return the frame requested by the previous call,
+        // after waiting for it to be finished. The first call waits for its own frame.
+        // The returned frame stays valid until the next call.
+        const CubeFrame& nextFrame(const GameTimePoint& time, const glm::mat4& viewProjection);
+    };
+}
@@ -1,9 +1,9 @@
 #include "CubeRenderer.hpp"
 
 #include <vector>
-#include <algorithm>
-#include <iterator>
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 #include <glm/gtc/constants.hpp>
 #include <glm/vec4.hpp>
@@ -14,10 +14,27 @@
 
 #include "Util.hpp"
 #include "ShaderSources.hpp"
-#include "MeshData.hpp"
 
 namespace cubedemo
 {
+    // Frames of instance data that can be in flight on the GPU, before updates have to wait for it
+    static const size_t INSTANCE_BUFFER_FRAMES = 3;
+
+    static GLenum instanceTextureFormat(InstanceFormat format)
+    {
+        switch (format)
+        {
+        case InstanceFormat::Compact16:
+            return gl::RGBA16;
+        case InstanceFormat::StaticRotation:
+            return gl::RGBA32UI;
+        case InstanceFormat::GpuHelix:
+            return gl::R32UI;
+        default:
+            return gl::RGBA32F;
+        }
+    }
+
     static glm::vec3 calculateLightPosition(const glm::vec3& center, const GameTimePoint& time, float radius, float speed)
     {
         static const auto TWO_PI = glm::pi<float>() * 2.0f;
@@ -29,50 +46,89 @@ namespace cubedemo
         return glm::vec3{ x, center.y, z };
     }
 
-    CubeRenderer::CubeRenderer()
-        : m_instanceCount{ 0 },
-        m_positionsBuffer{ gl::RGBA32F },
-        m_opacitiesBuffer{ gl::R32F },
-        m_scalesBuffer{ gl::R32F },
-        m_rotationsBuffer{ gl::RGBA32F },
+    CubeRenderer::CubeRenderer(const MeshFile& mesh, InstanceFormat instanceFormat, CubeOrdering instanceOrdering)
+        : m_indexType{ GLenum(mesh.indexSize() == sizeof(uint16_t) ? gl::UNSIGNED_SHORT : gl::UNSIGNED_INT) },
+        m_vertexFormat{ mesh.vertexFormat() }, m_positionScale{ mesh.positionScale() },
+        m_instanceFormat{ instanceFormat }, m_instanceOrdering{ instanceOrdering }, m_drawRangeCount{ 0 },
+        m_instanceBuffer{ instanceTextureFormat(instanceFormat), INSTANCE_BUFFER_FRAMES },
+        m_instanceOrigin{ 0.0f }, m_instanceExtent{ 1.0f },
+        m_slotBuffer{ gl::RGBA32F }, m_time{ 0.0f }, m_frameBuilder{ instanceFormat, instanceOrdering },
         m_modelviewMatrix{ glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f)) },
         m_lightPosition{ 0.0f }
     {
         // generate buffers and textures
         gl::GenVertexArrays(1, &m_vao);
-        gl::GenBuffers(1, &m_positionsVBO);
-        gl::GenBuffers(1, &m_normalsVBO);
+        gl::GenBuffers(1, &m_verticesVBO);
         gl::GenBuffers(1, &m_indices);
         GL_CHECK_ERRORS;
 
-        // set up shader
-        m_shader.attachShaderFromSource(gl::VERTEX_SHADER, shaderSourceCubesVert());
+        // set up shader, for both the instance and the mesh vertex format
+        std::vector<const char*> defines;
+        if (m_instanceFormat == InstanceFormat::Compact16)
+            defines.push_back("COMPACT_INSTANCES");
+        else if (m_instanceFormat == InstanceFormat::StaticRotation)
+            defines.push_back("STATIC_ROTATION");
+        else if (m_instanceFormat == InstanceFormat::GpuHelix)
+            defines.push_back("GPU_HELIX");
+        if (m_instanceFormat == InstanceFormat::GpuHelix && m_instanceOrdering == CubeOrdering::Depth)
+            defines.push_back("SORTED_SLOTS");
+        if (m_vertexFormat != MeshVertexFormat::Float32)
+            defines.push_back("OCTAHEDRAL_NORMALS");
+        if (m_vertexFormat == MeshVertexFormat::Packed16)
+            defines.push_back("PACKED_POSITIONS");
+        m_shader.attachShaderFromSource(gl::VERTEX_SHADER, shaderSourceWithDefines(shaderSourceCubesVert(), defines));
         m_shader.attachShaderFromSource(gl::FRAGMENT_SHADER, shaderSourceCubesFrag());
         m_shader.link();
         m_shader.addAttributes({ "position", "normal" });
-        m_shader.addUniforms({ "MVP", "InstancePositions" , "ModelViewMatrix", "ProjectionMatrix", "NormalMatrix", "LightPosition", "LightIntensity", "Kd", "Ka", "Ks", "Shininess", "Gamma", "InstanceOpacities", "InstanceScales", "InstanceRotations" });
+        m_shader.addUniforms({ "MVP", "Instances", "InstanceOffset", "ModelViewMatrix", "ProjectionMatrix", "NormalMatrix", "LightPosition", "LightIntensity", "Kd", "Ka", "Ks", "Shininess", "Gamma" });
+        if (m_instanceFormat == InstanceFormat::Compact16)
+            m_shader.addUniforms({ "InstanceOrigin", "InstanceExtent", "InstanceMaxScale" });
+        else if (m_instanceFormat == InstanceFormat::StaticRotation)
+            m_shader.addUniforms({ "InstanceSlots", "Time" });
+        else if (m_instanceFormat == InstanceFormat::GpuHelix)
+            m_shader.addUniforms({ "InstanceSlots", "Time", "FadeSeconds", "HelixTimeScale" });
+        if (m_vertexFormat == MeshVertexFormat::Packed16)
+            m_shader.addUniforms({ "PositionScale" });
         GL_CHECK_ERRORS;
 
-        // set up vao
+        // levels of detail of the mesh
+        CC_ASSERT(mesh.lodCount() == CUBE_MESH_LODS)
+        for (size_t lod = 0; lod < CUBE_MESH_LODS; lod++)
+        {
+            m_meshLods[lod].indexOffset = mesh.indexSize() * mesh.lod(lod).firstIndex;
+            m_meshLods[lod].indexCount = mesh.lod(lod).indexCount;
+            m_meshLods[lod].baseVertex = GLint(mesh.lod(lod).baseVertex);
+        }
+
+        // set up vao, uploading straight from the mapped mesh file
         gl::BindVertexArray(m_vao);
         {
-            // "base" positions without instance offsets
-            gl::BindBuffer(gl::ARRAY_BUFFER, m_positionsVBO);
-            gl::BufferData(gl::ARRAY_BUFFER, sizeof(float) * 3 * ROUNDED_CUBE_VERTICES.size(), ROUNDED_CUBE_VERTICES.data(), gl::STATIC_DRAW);
+            // interleaved "base" positions without instance offsets, and normals, see MeshVertexFormat
+            auto stride = GLsizei(mesh.vertexStride());
+            gl::BindBuffer(gl::ARRAY_BUFFER, m_verticesVBO);
+            gl::BufferData(gl::ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices(), gl::STATIC_DRAW);
             gl::EnableVertexAttribArray(m_shader["position"]);
-            gl::VertexAttribPointer(m_shader["position"], 3, gl::FLOAT, gl::FALSE_, 0, nullptr);
-            GL_CHECK_ERRORS;
-
-            // normals
-            gl::BindBuffer(gl::ARRAY_BUFFER, m_normalsVBO);
-            gl::BufferData(gl::ARRAY_BUFFER, sizeof(float) * 3 * ROUNDED_CUBE_NORMALS.size(), ROUNDED_CUBE_NORMALS.data(), gl::STATIC_DRAW);
             gl::EnableVertexAttribArray(m_shader["normal"]);
-            gl::VertexAttribPointer(m_shader["normal"], 3, gl::FLOAT, gl::FALSE_, 0, nullptr);
+            if (m_vertexFormat == MeshVertexFormat::Packed16)
+            {
+                gl::VertexAttribPointer(m_shader["position"], 3, gl::SHORT, gl::TRUE_, stride, reinterpret_cast<const GLvoid*>(offsetof(PackedMeshVertex, position)));
+                gl::VertexAttribPointer(m_shader["normal"], 2, gl::SHORT, gl::TRUE_, stride, reinterpret_cast<const GLvoid*>(offsetof(PackedMeshVertex, normal)));
+            }
+            else if (m_vertexFormat == MeshVertexFormat::OctahedralNormals)
+            {
+                gl::VertexAttribPointer(m_shader["position"], 3, gl::FLOAT, gl::FALSE_, stride, reinterpret_cast<const GLvoid*>(offsetof(OctahedralMeshVertex, position)));
+                gl::VertexAttribPointer(m_shader["normal"], 2, gl::SHORT, gl::TRUE_, stride, reinterpret_cast<const GLvoid*>(offsetof(OctahedralMeshVertex, normal)));
+            }
+            else
+            {
+                gl::VertexAttribPointer(m_shader["position"], 3, gl::FLOAT, gl::FALSE_, stride, reinterpret_cast<const GLvoid*>(offsetof(MeshVertex, position)));
+                gl::VertexAttribPointer(m_shader["normal"], 3, gl::FLOAT, gl::FALSE_, stride, reinterpret_cast<const GLvoid*>(offsetof(MeshVertex, normal)));
+            }
             GL_CHECK_ERRORS;
 
             // indices
             gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, m_indices);
-            gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * ROUNDED_CUBE_INDICES.size(), ROUNDED_CUBE_INDICES.data(), gl::STATIC_DRAW);
+            gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indices(), gl::STATIC_DRAW);
         }
         gl::BindVertexArray(0);
     }
@@ -80,8 +136,7 @@ namespace cubedemo
     CubeRenderer::~CubeRenderer()
     {
         gl::DeleteBuffers(1, &m_indices);
-        gl::DeleteBuffers(1, &m_normalsVBO);
-        gl::DeleteBuffers(1, &m_positionsVBO);
+        gl::DeleteBuffers(1, &m_verticesVBO);
         gl::DeleteVertexArrays(1, &m_vao);
         GL_CHECK_ERRORS;
     }
@@ -91,37 +146,53 @@ namespace cubedemo
         m_projectionMatrix = glm::perspective(glm::quarter_pi<float>(), float(width) / height, 0.1f, 1000.0f);
     }
 
-    void CubeRenderer::update(const GameTimePoint& time, const CubeController& cubes)
+    void CubeRenderer::update(const GameTimePoint& time, const CubeController& cubes, float alpha)
     {
-        m_lightPosition = calculateLightPosition(glm::vec3(0.0f, 0.0f, 150.0f), time, 225.0f, 0.20f);
-
-        m_instanceCount = cubes.count();
-        std::vector<glm::vec4> processedPositions;
-        std::vector<glm::quat> processedRotations;
-        processedPositions.reserve(m_instanceCount);
-        processedRotations.reserve(m_instanceCount);
-
-        // Process vec3's to vec4's
-        // Note: w component is always 0 because this is an offset
-        // which will be added onto another vec4
-        auto positionSource = cubes.cubePositions();
-        std::transform(positionSource, positionSource + cubes.count(), std::back_inserter(processedPositions),
-            [](const glm::vec3& v) { return glm::vec4(v, 0.0f); });
-
-        // process axis, rotation speed, and time into quaternion rotations
-        auto rotationAxisSource = cubes.cubeRotationAxes();
-        auto rotationSpeedSource = cubes.cubeRotationSpeeds();
-        for (size_t i = 0; i < m_instanceCount; i++)
+        m_frameBuilder.build(time, cubes, alpha, viewProjection(), m_frame);
+        upload(m_frame);
+    }
+
+    void CubeRenderer::upload(const CubeFrame& frame)
+    {
+        m_lightPosition = calculateLightPosition(glm::vec3(0.0f, 0.0f, 150.0f), frame.time, 225.0f, 0.20f);
+        m_time = frame.time.total();
+        m_drawRangeCount = frame.drawRangeCount;
+        std::copy(frame.drawRanges, frame.drawRanges + frame.drawRangeCount, m_drawRanges);
+        m_instanceOrigin = frame.instanceOrigin;
+        m_instanceExtent = frame.instanceExtent;
+
+        auto slotBytes = sizeof(glm::vec4) * slotTexels(m_instanceFormat);
+        if (frame.allSlots)
         {
-            float angle = time.total() * rotationSpeedSource[i];
-            glm::quat rotation = glm::angleAxis(angle, rotationAxisSource[i]);
-            processedRotations.push_back(rotation);
+            CC_ASSERT(frame.slotRanges.size() == 1 && frame.slotRanges[0].begin == 0)
+            m_slotBuffer.updateData(slotBytes * frame.slotRanges[0].end, frame.slotData, gl::DYNAMIC_DRAW);
+        }
+        else
+        {
+            auto data = reinterpret_cast<const char*>(frame.slotData);
+            for (const auto& range : frame.slotRanges)
+            {
+                auto bytes = slotBytes * (range.end - range.begin);
+                m_slotBuffer.updateSubData(slotBytes * range.begin, bytes, data);
+                data += bytes;
+            }
         }
 
-        m_positionsBuffer.updateData(sizeof(glm::vec4) * processedPositions.size(), processedPositions.data(), gl::STREAM_DRAW);
-        m_opacitiesBuffer.updateData(sizeof(float) * cubes.count(), cubes.cubeOpacities(), gl::STREAM_DRAW);
-        m_scalesBuffer.updateData(sizeof(float) * cubes.count(), cubes.cubeScales(), gl::STREAM_DRAW);
-        m_rotationsBuffer.updateData(sizeof(glm::quat) * processedRotations.size(), processedRotations.data(), gl::STREAM_DRAW);
+        auto recordSize = instanceRecordSize(m_instanceFormat, m_instanceOrdering);
+        if (recordSize > 0 && frame.drawCount > 0)
+            m_instanceBuffer.updateData(recordSize * frame.drawCount, frame.instances, gl::STREAM_DRAW);
+    }
+
+    void CubeRenderer::drawInstances(const CubeDrawRange& range)
+    {
+        if (range.count == 0)
+            return;
+
+        const auto& mesh = m_meshLods[range.lod];
+        gl::Uniform1i(m_shader("InstanceOffset"), GLint(range.first));
+        gl::DrawElementsInstancedBaseVertex(gl::TRIANGLES, GLsizei(mesh.indexCount), m_indexType,
+            reinterpret_cast<const GLvoid*>(mesh.indexOffset), GLsizei(range.count), mesh.baseVertex);
+        GL_CHECK_ERRORS;
     }
 
     void CubeRenderer::render()
@@ -140,10 +211,8 @@ namespace cubedemo
         gl::BindVertexArray(m_vao);
         m_shader.use();
         {
-            m_positionsBuffer.bind(0, m_shader("InstancePositions")); // Position buffer texture
-            m_opacitiesBuffer.bind(1, m_shader("InstanceOpacities")); // Opacity buffer texture
-            m_scalesBuffer.bind(2, m_shader("InstanceScales")); // Scale buffer texture
-            m_rotationsBuffer.bind(3, m_shader("InstanceRotations")); // Rotation buffer texture
+            if (instanceRecordSize(m_instanceFormat, m_instanceOrdering) > 0)
+                m_instanceBuffer.bind(0, m_shader("Instances")); // Instance buffer texture
 
             // Uniforms
             gl::UniformMatrix4fv(m_shader("MVP"), 1, gl::FALSE_, glm::value_ptr(mvp));
@@ -157,11 +226,54 @@ namespace cubedemo
             gl::Uniform3fv(m_shader("Ka"), 1, glm::value_ptr(AMBIENT_COLOR));
             gl::Uniform3fv(m_shader("Ks"), 1, glm::value_ptr(SPECULAR_COLOR));
             gl::Uniform1f(m_shader("Gamma"), GAMMA);
+            if (m_instanceFormat == InstanceFormat::StaticRotation || m_instanceFormat == InstanceFormat::GpuHelix)
+            {
+                m_slotBuffer.bind(1, m_shader("InstanceSlots"));
+                gl::Uniform1f(m_shader("Time"), m_time);
+            }
+            if (m_instanceFormat == InstanceFormat::GpuHelix)
+            {
+                gl::Uniform1f(m_shader("FadeSeconds"), CUBE_FADE_SECONDS);
+                gl::Uniform1f(m_shader("HelixTimeScale"), CUBE_HELIX_TIME_SCALE);
+            }
+            if (m_instanceFormat == InstanceFormat::Compact16)
+            {
+                gl::Uniform3fv(m_shader("InstanceOrigin"), 1, glm::value_ptr(m_instanceOrigin));
+                gl::Uniform3fv(m_shader("InstanceExtent"), 1, glm::value_ptr(m_instanceExtent));
+                gl::Uniform1f(m_shader("InstanceMaxScale"), MAX_INSTANCE_SCALE);
+            }
+            if (m_vertexFormat == MeshVertexFormat::Packed16)
+                gl::Uniform1f(m_shader("PositionScale"), m_positionScale);
             GL_CHECK_ERRORS;
 
-            // Draw instanced elements
-            gl::DrawElementsInstanced(gl::TRIANGLES, GLsizei(ROUNDED_CUBE_INDICES.size()), gl::UNSIGNED_INT, nullptr, GLsizei(m_instanceCount));
-            GL_CHECK_ERRORS;
+            if (m_instanceOrdering == CubeOrdering::Depth)
+            {
+                // Opaque cubes come first, front to back. Without blending, hidden fragments are rejected by the depth test
+                // before shading. Translucent cubes follow back to front, and must not hide each other.
+                gl::Disable(gl::BLEND);
+                for (size_t i = 0; i < m_drawRangeCount; i++)
+                {
+                    if (!m_drawRanges[i].translucent)
+                        drawInstances(m_drawRanges[i]);
+                }
+                gl::Enable(gl::BLEND);
+                gl::DepthMask(gl::FALSE_);
+                for (size_t i = 0; i < m_drawRangeCount; i++)
+                {
+                    if (m_drawRanges[i].translucent)
+                        drawInstances(m_drawRanges[i]);
+                }
+                gl::DepthMask(gl::TRUE_);
+            }
+            else
+            {
+                // Unordered, so everything is blended and writes depth
+                for (size_t i = 0; i < m_drawRangeCount; i++)
+                    drawInstances(m_drawRanges[i]);
+            }
+
+            // Keep this frame's instance data from being overwritten until the draw is done
+            m_instanceBuffer.fence();
         }
         m_shader.unuse();
         gl::BindVertexArray(0);
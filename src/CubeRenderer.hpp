@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <glm/matrix.hpp>
 
 #include "gl_core_4_1.hpp"
@@ -9,6 +12,8 @@
 #include "GameTime.hpp"
 #include "NonCopyable.hpp"
 #include "CubeController.hpp"
+#include "CubeFrame.hpp"
+#include "MeshFile.hpp"
 
 namespace cubedemo
 {
@@ -21,16 +26,38 @@ namespace cubedemo
 
     private:
         GLuint m_vao; // Vertex array object
-        GLuint m_positionsVBO; // VBO for base position data
-        GLuint m_normalsVBO; // VBO for normal data
+        GLuint m_verticesVBO; // VBO for interleaved base positions and normals
         GLuint m_indices; // EBO for cube indices
+        GLenum m_indexType; // Type of the indices in m_indices
+        MeshVertexFormat m_vertexFormat; // Format of m_verticesVBO
+        float m_positionScale; // Factor of the packed positions of MeshVertexFormat::Packed16
         GLShader m_shader; // GLSL shader program
 
-        size_t m_instanceCount; // Count of instances to render
-        GLTextureBuffer m_positionsBuffer; // Instance Positions
-        GLTextureBuffer m_opacitiesBuffer; // Instance Opacities
-        GLTextureBuffer m_scalesBuffer; // Instance size adjustment
-        GLTextureBuffer m_rotationsBuffer; // Instance rotations
+        // Every level of detail of the cube mesh lives in the same buffers, each with indices starting at 0
+        struct MeshLodRange
+        {
+            size_t indexOffset; // Offset of the indices in the EBO, in bytes
+            size_t indexCount;
+            GLint baseVertex; // Offset of the vertices in the VBO
+        };
+        MeshLodRange m_meshLods[CUBE_MESH_LODS];
+
+        InstanceFormat m_instanceFormat; // Format of m_instanceBuffer
+        CubeOrdering m_instanceOrdering; // Order of the instances in m_instanceBuffer
+        // Instances to render by level of detail, only the visible living cubes that intersect the view frustum
+        CubeDrawRange m_drawRanges[CubeFrame::MAX_DRAW_RANGES];
+        size_t m_drawRangeCount;
+        GLTextureBuffer m_instanceBuffer; // Instance data, see InstanceFormat
+        glm::vec3 m_instanceOrigin; // Minimum corner of the quantized instance positions
+        glm::vec3 m_instanceExtent; // Size of the bounds of the quantized instance positions
+
+        // Per-slot data that only changes when cubes spawn, for InstanceFormat::StaticRotation and GpuHelix
+        GLTextureBuffer m_slotBuffer; // slotTexels() texels per slot, see CubeFrameBuilder
+        float m_time; // Time of the last upload, in seconds
+
+        // Frames built by update
+        CubeFrameBuilder m_frameBuilder;
+        CubeFrame m_frame;
 
         // Matrices
         glm::mat4 m_projectionMatrix;
@@ -38,13 +65,32 @@ namespace cubedemo
 
         glm::vec3 m_lightPosition;
 
+        void drawInstances(const CubeDrawRange& range); // Draw a range of instances with the current state
+
     public:
-        CubeRenderer();
+        // mesh: Levels of detail of the cube mesh, with CUBE_MESH_LODS levels, only used during construction
+        explicit CubeRenderer(const MeshFile& mesh, InstanceFormat instanceFormat = InstanceFormat::Float32, CubeOrdering instanceOrdering = CubeOrdering::Slot);
         ~CubeRenderer();
 
+        inline InstanceFormat instanceFormat() const { return m_instanceFormat; }
+        inline CubeOrdering instanceOrdering() const { return m_instanceOrdering; }
+        inline glm::mat4 viewProjection() const { return m_projectionMatrix * m_modelviewMatrix; }
+
         void onWindowSizeChanged(size_t width, size_t height); // Notify the renderer of a changed window size, to allow it to update the projection matrix
 
-        void update(const GameTimePoint& time, const CubeController& cubes); // Update renderer state, pulling data from a FloatingCubes instance
-        void render(); // Draw latest cube data to the screen
+        // Update renderer state, pulling data from a FloatingCubes instance.
+        // alpha interpolates between the previous (0) and the latest (1) cube states.
+        // Cubes outside the view frustum are culled here, so this must be called after any change to the matrices.
+        // Uploads data of the slots in the dirty ranges of the cubes, which should be cleared afterwards.
+        void update(const GameTimePoint& time, const CubeController& cubes, float alpha = 1.0f);
+
+        // Upload a frame built elsewhere, with a CubeFrameBuilder for instanceFormat() and instanceOrdering().
+        // Frames have to come from a single builder in the order they were built, so this can't be mixed with update.
+        void upload(const CubeFrame& frame);
+
+        // Draw latest cube data to the screen, with one draw per level of detail. With CubeOrdering::Depth, opaque cubes
+        // are drawn without blending first, then translucent cubes without depth writes. Expects blending to be enabled,
+        // and leaves it that way.
+        void render();
     };
 }
@@ -0,0 +1,291 @@
+// Headless benchmark for the cube simulation.
+// Drives CubeController::update with synthetic time points, without any window or GL context,
+// rebuilds a SpatialGrid and sorts the cubes by depth after every update,
+// and reports the results as one JSON object per line.
+
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include "Util.hpp"
+#include "GameTime.hpp"
+#include "CpuFeatures.hpp"
+#include "WorkerPool.hpp"
+#include "CubeController.hpp"
+#include "SpatialGrid.hpp"
+#include "RadixSort.hpp"
+
+using namespace cubedemo;
+
+struct BenchOptions
+{
+    std::vector<int> cubeCounts{ 3500, 100000, 1000000 };
+    int frames = 600; // Measured frames per cube count
+    int warmupFrames = 60; // Frames run before measuring
+    float frameMilliseconds = 1000.0f / 60.0f; // Synthetic time between frames
+    size_t threads = WorkerPool::defaultThreadCount() + 1; // Threads including the main thread
+    CubeUpdateMode mode = CubeUpdateMode::Analytic;
+    uint64_t seed = CubeController::DEFAULT_SEED;
+    float startTime = -1.0f; // Synthetic start time in seconds, negative to start once all cubes may be alive
+    std::string outputPath; // Write results to this file instead of stdout
+};
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+        << "  --cubes N[,N...]    Cube counts to benchmark (default 3500,100000,1000000)\n"
+        << "  --frames N          Measured frames per cube count (default 600)\n"
+        << "  --warmup N          Unmeasured frames before measuring (default 60)\n"
+        << "  --dt MS             Synthetic frame time in milliseconds (default 16.67)\n"
+        << "  --threads N         Threads including the main thread, 1 disables the worker pool\n"
+        << "  --mode MODE         'analytic' (default) or 'integrated'\n"
+        << "  --seed N            Seed for spawning cubes\n"
+        << "  --start-time S      Synthetic time of the first frame, in seconds\n"
+        << "                      (default: the time at which all cubes may be alive)\n"
+        << "  --output FILE       Write results to FILE instead of stdout\n";
+}
+
+static bool parseOptions(int argc, char const *argv[], BenchOptions& options)
+{
+    for (auto i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc)
+        {
+            LOG_ERROR("Missing value for " << arg);
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--cubes")
+        {
+            options.cubeCounts.clear();
+            std::stringstream stream{ value };
+            std::string item;
+            while (std::getline(stream, item, ','))
+                options.cubeCounts.push_back(std::atoi(item.c_str()));
+        }
+        else if (arg == "--frames")
+            options.frames = std::atoi(value.c_str());
+        else if (arg == "--warmup")
+            options.warmupFrames = std::atoi(value.c_str());
+        else if (arg == "--dt")
+            options.frameMilliseconds = float(std::atof(value.c_str()));
+        else if (arg == "--threads")
+            options.threads = size_t(std::max(1, std::atoi(value.c_str())));
+        else if (arg == "--seed")
+            options.seed = std::strtoull(value.c_str(), nullptr, 0);
+        else if (arg == "--start-time")
+            options.startTime = float(std::atof(value.c_str()));
+        else if (arg == "--output")
+            options.outputPath = value;
+        else if (arg == "--mode" && (value == "analytic" || value == "integrated"))
+            options.mode = value == "analytic" ? CubeUpdateMode::Analytic : CubeUpdateMode::Integrated;
+        else
+        {
+            LOG_ERROR("Invalid argument " << arg << " " << value);
+            return false;
+        }
+    }
+
+    for (auto count : options.cubeCounts)
+    {
+        if (count <= 0)
+        {
+            LOG_ERROR("Cube counts must be positive");
+            return false;
+        }
+    }
+    return options.frames > 0 && options.warmupFrames >= 0 && options.frameMilliseconds > 0.0f;
+}
+
+// Find the earliest time at which all cubes may be alive, by bisection
+static float fullPopulationTime(int cubeCount)
+{
+    float lo = 0.0f, hi = 1.0f;
+    while (CubeController::aliveCubesForTime(GameTimePoint(0.0f, hi), cubeCount) < cubeCount)
+        hi *= 2.0f;
+    for (auto i = 0; i < 32; i++)
+    {
+        auto mid = 0.5f * (lo + hi);
+        if (CubeController::aliveCubesForTime(GameTimePoint(0.0f, mid), cubeCount) < cubeCount)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return hi;
+}
+
+// Nearest-rank percentile of sorted values
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    auto rank = size_t(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+static double mean(const std::vector<double>& values)
+{
+    double total = 0.0;
+    for (auto value : values)
+        total += value;
+    return total / values.size();
+}
+
+// Write timing statistics in milliseconds as a JSON object. Sorts the given nanoseconds.
+static void writeTimings(std::ostream& out, const char *name, std::vector<double>& nanoseconds)
+{
+    auto meanNanoseconds = mean(nanoseconds);
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    out << ",\"" << name << "\":{"
+        << "\"mean\":" << meanNanoseconds * 1e-6
+        << ",\"min\":" << nanoseconds.front() * 1e-6
+        << ",\"p50\":" << percentile(nanoseconds, 50.0) * 1e-6
+        << ",\"p90\":" << percentile(nanoseconds, 90.0) * 1e-6
+        << ",\"p99\":" << percentile(nanoseconds, 99.0) * 1e-6
+        << ",\"max\":" << nanoseconds.back() * 1e-6
+        << "}";
+}
+
+// Keys as wide as CubeFrameBuilder uses
+static const uint32_t DEPTH_KEY_BITS = 22;
+
+// Key the living cubes by depth along the z axis, for sorting them
+static void buildDepthKeys(const CubeController& cubes, RadixSorter& sorter)
+{
+    static const float DEPTH_RANGE = 1000.0f; // Depths are expected in [-DEPTH_RANGE, DEPTH_RANGE]
+
+    auto count = cubes.aliveCount();
+    auto indices = cubes.aliveIndices();
+    auto positions = cubes.cubePositions();
+    auto pairs = sorter.pairs();
+    auto scale = float((1u << DEPTH_KEY_BITS) - 1) / (2.0f * DEPTH_RANGE);
+    for (size_t k = 0; k < count; k++)
+    {
+        auto depth = std::min(std::max(positions[indices[k]].z + DEPTH_RANGE, 0.0f), 2.0f * DEPTH_RANGE);
+        pairs[k].key = uint32_t(depth * scale);
+        pairs[k].value = indices[k];
+    }
+}
+
+static double elapsedNanoseconds(std::chrono::steady_clock::time_point before, std::chrono::steady_clock::time_point after)
+{
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+}
+
+static void runBenchmark(const BenchOptions& options, int cubeCount, WorkerPool *workers, std::ostream& out)
+{
+    CubeController cubes{ cubeCount, options.seed };
+    cubes.setWorkerPool(workers);
+    cubes.setUpdateMode(options.mode);
+    SpatialGrid grid;
+    grid.setWorkerPool(workers);
+    RadixSorter sorter;
+    sorter.setWorkerPool(workers);
+    sorter.reserve(size_t(cubeCount));
+
+    auto startTime = options.startTime >= 0.0f ? options.startTime : fullPopulationTime(cubeCount);
+    auto frameSeconds = options.frameMilliseconds * 0.001f;
+    auto frame = 0;
+    auto nextTime = [&] { return GameTimePoint(options.frameMilliseconds, startTime + frameSeconds * frame++); };
+
+    for (auto i = 0; i < options.warmupFrames; i++)
+    {
+        cubes.update(nextTime());
+        grid.rebuild(cubes);
+        buildDepthKeys(cubes, sorter);
+        sorter.sort(cubes.aliveCount(), DEPTH_KEY_BITS);
+        cubes.clearDirtyRanges();
+    }
+
+    std::vector<double> updateNanoseconds, gridNanoseconds, keyNanoseconds, sortNanoseconds;
+    updateNanoseconds.reserve(options.frames);
+    gridNanoseconds.reserve(options.frames);
+    keyNanoseconds.reserve(options.frames);
+    sortNanoseconds.reserve(options.frames);
+    double aliveSum = 0.0;
+    for (auto i = 0; i < options.frames; i++)
+    {
+        auto time = nextTime();
+        auto before = std::chrono::steady_clock::now();
+        cubes.update(time);
+        auto afterUpdate = std::chrono::steady_clock::now();
+        grid.rebuild(cubes);
+        auto afterGrid = std::chrono::steady_clock::now();
+        buildDepthKeys(cubes, sorter);
+        auto afterKeys = std::chrono::steady_clock::now();
+        sorter.sort(cubes.aliveCount(), DEPTH_KEY_BITS);
+        auto afterSort = std::chrono::steady_clock::now();
+        cubes.clearDirtyRanges(); // Nothing mirrors the cubes here
+
+        updateNanoseconds.push_back(elapsedNanoseconds(before, afterUpdate));
+        gridNanoseconds.push_back(elapsedNanoseconds(afterUpdate, afterGrid));
+        keyNanoseconds.push_back(elapsedNanoseconds(afterGrid, afterKeys));
+        sortNanoseconds.push_back(elapsedNanoseconds(afterKeys, afterSort));
+        aliveSum += double(cubes.aliveCount());
+    }
+
+    auto meanUpdate = mean(updateNanoseconds);
+    auto meanGrid = mean(gridNanoseconds);
+    auto meanSort = mean(sortNanoseconds);
+    auto meanAlive = aliveSum / options.frames;
+
+    out << "{\"benchmark\":\"update\""
+        << ",\"cubes\":" << cubeCount
+        << ",\"frames\":" << options.frames
+        << ",\"threads\":" << (workers != nullptr ? workers->concurrency() : 1)
+        << ",\"mode\":\"" << (options.mode == CubeUpdateMode::Analytic ? "analytic" : "integrated") << "\""
+        << ",\"simd\":\"" << simdLevelName(simdLevel()) << "\""
+        << ",\"start_time_s\":" << startTime
+        << ",\"alive_mean\":" << meanAlive
+        << ",\"ns_per_cube\":" << (meanAlive > 0.0 ? meanUpdate / meanAlive : 0.0)
+        << ",\"frames_per_sec\":" << (meanUpdate > 0.0 ? 1e9 / meanUpdate : 0.0);
+    writeTimings(out, "frame_ms", updateNanoseconds);
+    out << ",\"grid_cells\":" << grid.cellCount()
+        << ",\"grid_cell_size\":" << grid.cellSize()
+        << ",\"grid_ns_per_cube\":" << (meanAlive > 0.0 ? meanGrid / meanAlive : 0.0);
+    writeTimings(out, "grid_ms", gridNanoseconds);
+    writeTimings(out, "depth_key_ms", keyNanoseconds);
+    out << ",\"sort_ns_per_cube\":" << (meanAlive > 0.0 ? meanSort / meanAlive : 0.0);
+    writeTimings(out, "sort_ms", sortNanoseconds);
+    out << "}" << std::endl;
+}
+
+int main(int argc, char const *argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream file;
+    if (!options.outputPath.empty())
+    {
+        file.open(options.outputPath);
+        if (!file)
+        {
+            LOG_ERROR("Could not open " << options.outputPath << " for writing");
+            return EXIT_FAILURE;
+        }
+    }
+    auto& out = options.outputPath.empty() ? std::cout : file;
+
+    std::unique_ptr<WorkerPool> workers;
+    if (options.threads > 1)
+        workers.reset(new WorkerPool(options.threads - 1));
+
+    for (auto count : options.cubeCounts)
+        runBenchmark(options, count, workers.get(), out);
+
+    return EXIT_SUCCESS;
+}
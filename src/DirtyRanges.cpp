@@ -0,0 +1,49 @@
+#include "DirtyRanges.hpp"
+
+#include <algorithm>
+
+namespace cubedemo
+{
+    DirtyRanges::DirtyRanges(size_t maxRanges)
+        : m_maxRanges{ maxRanges }
+    {
+        m_ranges.reserve(maxRanges + 1);
+    }
+
+    void DirtyRanges::addRange(uint32_t begin, uint32_t end)
+    {
+        m_ranges.push_back(Range{ begin, end });
+        if (m_ranges.size() > m_maxRanges)
+        {
+            Range cover = m_ranges[0];
+            for (const auto& range : m_ranges)
+            {
+                cover.begin = std::min(cover.begin, range.begin);
+                cover.end = std::max(cover.end, range.end);
+            }
+            m_ranges.assign(1, cover);
+        }
+    }
+
+    void DirtyRanges::add(const DirtyRanges& other)
+    {
+        for (const auto& range : other.m_ranges)
+            add(range.begin, range.end);
+    }
+
+    void DirtyRanges::merged(uint32_t maxGap, std::vector<Range>& out) const
+    {
+        out.assign(m_ranges.begin(), m_ranges.end());
+        std::sort(out.begin(), out.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+        size_t count = 0;
+        for (const auto& range : out)
+        {
+            if (count > 0 && range.begin <= out[count - 1].end + maxGap)
+                out[count - 1].end = std::max(out[count - 1].end, range.end);
+            else
+                out[count++] = range;
+        }
+        out.resize(count);
+    }
+}
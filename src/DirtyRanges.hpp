@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace cubedemo
+{
+    // A set of index ranges of an array that changed, so copies of the array only have to update those.
+    // Ranges are kept in the order they were added, extending the last one while indices are adjacent,
+    // and are sorted and merged when read.
+    class DirtyRanges
+    {
+    public:
+        // [begin, end) of a dirty range
+        struct Range
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        static const size_t DEFAULT_MAX_RANGES = 4096;
+
+    private:
+        std::vector<Range> m_ranges; // Unsorted, may overlap. Never grows beyond its initial capacity.
+        size_t m_maxRanges;
+
+        void addRange(uint32_t begin, uint32_t end); // Append a range that doesn't touch the last one
+
+    public:
+        // Once there are more than maxRanges ranges, they are replaced by one range covering all of them.
+        // This bounds memory use when nobody clears the set, and all memory is reserved up front.
+        explicit DirtyRanges(size_t maxRanges = DEFAULT_MAX_RANGES);
+
+        inline size_t maxRanges() const { return m_maxRanges; }
+        inline bool empty() const { return m_ranges.empty(); }
+        inline void clear() { m_ranges.clear(); }
+
+        // Mark [begin, end) as dirty. Indices mostly arrive in ascending runs, which only grow the last range.
+        inline void add(uint32_t begin, uint32_t end)
+        {
+            if (!m_ranges.empty() && begin <= m_ranges.back().end && end >= m_ranges.back().begin)
+            {
+                if (begin < m_ranges.back().begin)
+                    m_ranges.back().begin = begin;
+                if (end > m_ranges.back().end)
+                    m_ranges.back().end = end;
+            }
+            else if (begin < end)
+                addRange(begin, end);
+        }
+        inline void add(uint32_t index) { add(index, index + 1); }
+        void add(const DirtyRanges& other); // Mark everything that is dirty in other
+
+        // Get sorted, disjoint ranges covering all dirty indices. Ranges at most maxGap indices apart are joined,
+        // since one larger copy is usually cheaper than several small ones. Needs no more than maxRanges() + 1 entries in out.
+        void merged(uint32_t maxGap, std::vector<Range>& out) const;
+    };
+}
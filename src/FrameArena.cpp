@@ -0,0 +1,63 @@
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    static char* alignPointer(char *pointer, size_t alignment)
+    {
+        auto address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+
+    FrameArena::FrameArena(size_t capacity)
+        : m_base{ nullptr }, m_capacity{ 0 }, m_used{ 0 }, m_peak{ 0 }
+    {
+        reserve(capacity);
+    }
+
+    void FrameArena::reserve(size_t capacity)
+    {
+        CC_ASSERT(m_used == 0 && m_overflow.empty())
+        if (capacity <= m_capacity)
+            return;
+
+        m_block.reset(new char[capacity + CACHE_LINE_SIZE]);
+        m_base = alignPointer(m_block.get(), CACHE_LINE_SIZE);
+        m_capacity = capacity;
+    }
+
+    void FrameArena::reset()
+    {
+        auto peak = m_peak;
+        m_overflow.clear();
+        m_used = 0;
+        m_peak = 0;
+        reserve(peak);
+    }
+
+    void* FrameArena::allocate(size_t size, size_t alignment)
+    {
+        CC_ASSERT(alignment > 0 && alignment <= CACHE_LINE_SIZE && (alignment & (alignment - 1)) == 0)
+
+        // Every allocation may need up to a cache line of padding, count that towards the peak
+        // so the grown block is large enough for the same allocations next frame
+        m_peak += size + CACHE_LINE_SIZE;
+        if (m_base != nullptr)
+        {
+            auto start = alignPointer(m_base + m_used, alignment);
+            auto end = size_t(start - m_base) + size;
+            if (end <= m_capacity)
+            {
+                m_used = end;
+                return start;
+            }
+        }
+
+        m_overflow.emplace_back(new char[size + CACHE_LINE_SIZE]);
+        return alignPointer(m_overflow.back().get(), alignment);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#include "NonCopyable.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace cubedemo
+{
+    // Linear allocator for scratch memory that is only needed until the end of a frame.
+    // Allocations bump an offset into one block, and reset() releases all of them at once.
+    // Allocations that don't fit go to the heap instead, and the next reset() grows the block
+    // to the peak usage of the frame, so the heap is only touched until the arena has warmed up.
+    class FrameArena : NonCopyable
+    {
+    private:
+        std::unique_ptr<char[]> m_block;
+        char *m_base; // First cache line aligned byte of m_block
+        size_t m_capacity; // Usable bytes from m_base
+        size_t m_used; // Bytes allocated from the block since the last reset
+        size_t m_peak; // Bytes allocated since the last reset, including overflow allocations
+        std::vector<std::unique_ptr<char[]>> m_overflow; // Allocations that didn't fit into the block
+
+    public:
+        explicit FrameArena(size_t capacity = 0);
+
+        inline size_t capacity() const { return m_capacity; }
+        inline size_t used() const { return m_used; }
+
+        // Make sure the block holds at least capacity bytes. Only allowed right after a reset.
+        void reserve(size_t capacity);
+
+        // Release all allocations
+        void reset();
+
+        // Allocate size bytes, aligned to a power of two of at most CACHE_LINE_SIZE
+        void* allocate(size_t size, size_t alignment = CACHE_LINE_SIZE);
+
+        // Allocate uninitialized storage for count objects, which are never destroyed
+        template<typename T>
+        T* allocateArray(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+            return static_cast<T*>(allocate(sizeof(T) * count, CACHE_LINE_SIZE));
+        }
+    };
+}
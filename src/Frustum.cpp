@@ -0,0 +1,65 @@
+#include "Frustum.hpp"
+
+#include <glm/geometric.hpp>
+
+namespace cubedemo
+{
+    static inline float planeDistance(const glm::vec4& plane, const glm::vec3& point)
+    {
+        return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+    }
+
+    Frustum::Frustum()
+    {
+        for (auto& plane : m_planes)
+            plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    Frustum::Frustum(const glm::mat4& viewProjection)
+    {
+        // Gribb & Hartmann: every plane is the sum or difference of the last row and one other row,
+        // matching the clip space conditions -w <= x, y, z <= w
+        auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+        m_planes[0] = row(3) + row(0);
+        m_planes[1] = row(3) - row(0);
+        m_planes[2] = row(3) + row(1);
+        m_planes[3] = row(3) - row(1);
+        m_planes[4] = row(3) + row(2);
+        m_planes[5] = row(3) - row(2);
+
+        // Normalize, so plane distances are actual distances and can be compared against radii
+        for (auto& plane : m_planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const auto& plane : m_planes)
+        {
+            if (planeDistance(plane, center) < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersectsBox(const glm::vec3& min, const glm::vec3& max) const
+    {
+        return classifyBox(min, max) != Containment::Outside;
+    }
+
+    Containment Frustum::classifyBox(const glm::vec3& min, const glm::vec3& max) const
+    {
+        auto result = Containment::Inside;
+        for (const auto& plane : m_planes)
+        {
+            // Test the corners furthest along and furthest against the plane normal
+            glm::vec3 inner{ plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z };
+            glm::vec3 outer{ plane.x >= 0.0f ? min.x : max.x, plane.y >= 0.0f ? min.y : max.y, plane.z >= 0.0f ? min.z : max.z };
+            if (planeDistance(plane, inner) < 0.0f)
+                return Containment::Outside;
+            if (planeDistance(plane, outer) < 0.0f)
+                result = Containment::Intersects;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace cubedemo
+{
+    // How a volume relates to a frustum
+    enum class Containment
+    {
+        Outside,
+        Intersects,
+        Inside,
+    };
+
+    // The six planes of a view frustum, pointing inwards.
+    // Each plane is stored as (normal, distance), so a point p is on the inner side if dot(normal, p) + distance >= 0.
+    class Frustum final
+    {
+    public:
+        static const int PLANE_COUNT = 6;
+
+    private:
+        glm::vec4 m_planes[PLANE_COUNT]; // Left, right, bottom, top, near, far
+
+    public:
+        Frustum(); // A frustum that contains everything
+        explicit Frustum(const glm::mat4& viewProjection); // Extract the planes of a GL view projection matrix
+
+        inline const glm::vec4& plane(int index) const { return m_planes[index]; }
+
+        bool intersectsSphere(const glm::vec3& center, float radius) const;
+        bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+        Containment classifyBox(const glm::vec3& min, const glm::vec3& max) const;
+    };
+}
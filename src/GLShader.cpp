@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <functional>
+#include <stdexcept>
 
 #include "Util.hpp"
 
@@ -112,4 +113,25 @@ namespace cubedemo
 	{
 		return m_uniforms.at(uniformName);
 	}
+
+	// Shaders only have a handful of names, so a linear search is about as fast as hashing
+	static GLuint findLocation(const std::unordered_map<std::string, GLuint>& locations, const char *name)
+	{
+		for (const auto& location : locations)
+		{
+			if (location.first == name)
+				return location.second;
+		}
+		throw std::out_of_range(name);
+	}
+
+	GLuint GLShader::operator[](const char *attribName) const
+	{
+		return findLocation(m_attributes, attribName);
+	}
+
+	GLuint GLShader::operator()(const char *uniformName) const
+	{
+		return findLocation(m_uniforms, uniformName);
+	}
 }
@@ -36,5 +36,9 @@ namespace cubedemo
 
 		GLuint operator[](const std::string& attribName) const;
 		GLuint operator()(const std::string& uniformName) const;
+
+		// Lookups by C string, which don't construct a temporary std::string, so they never allocate in render loops
+		GLuint operator[](const char *attribName) const;
+		GLuint operator()(const char *uniformName) const;
 	};
 }
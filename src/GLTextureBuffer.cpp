@@ -1,38 +1,159 @@
 #include "GLTextureBuffer.hpp"
 
+#include <cstring>
+#include <algorithm>
+
 #include "Util.hpp"
 
 namespace cubedemo
 {
-    GLTextureBuffer::GLTextureBuffer(GLenum textureFormat)
-        : m_textureFormat{ textureFormat }
+    static const GLuint64 FENCE_TIMEOUT_NS = 1000000; // Wait for fences in steps of 1 ms
+
+    GLTextureBuffer::GLTextureBuffer(GLenum textureFormat, size_t regionCount)
+        : m_regions(regionCount), m_currentRegion{ 0 }, m_textureFormat{ textureFormat }
     {
-        gl::GenTextures(1, &m_textureID);
-        gl::GenBuffers(1, &m_bufferID);
+        CC_ASSERT(regionCount > 0)
+        for (auto& region : m_regions)
+        {
+            gl::GenTextures(1, &region.textureID);
+            gl::GenBuffers(1, &region.bufferID);
+            region.capacity = 0;
+            region.fence = nullptr;
+
+            // The texture stays attached to its buffer, even when the buffer storage is reallocated
+            gl::BindBuffer(gl::TEXTURE_BUFFER, region.bufferID);
+            gl::BindTexture(gl::TEXTURE_BUFFER, region.textureID);
+            gl::TexBuffer(gl::TEXTURE_BUFFER, m_textureFormat, region.bufferID);
+        }
+        gl::BindTexture(gl::TEXTURE_BUFFER, 0);
+        gl::BindBuffer(gl::TEXTURE_BUFFER, 0);
+        GL_CHECK_ERRORS;
     }
 
     GLTextureBuffer::~GLTextureBuffer()
     {
-        gl::DeleteTextures(1, &m_textureID);
-        gl::DeleteBuffers(1, &m_bufferID);
+        for (auto& region : m_regions)
+        {
+            if (region.fence != nullptr)
+                gl::DeleteSync(region.fence);
+            gl::DeleteTextures(1, &region.textureID);
+            gl::DeleteBuffers(1, &region.bufferID);
+        }
     }
 
     void GLTextureBuffer::bind(unsigned int texUnitIndex, unsigned int uniformLocation) const
     {
         gl::ActiveTexture(gl::TEXTURE0 + texUnitIndex);
-        gl::BindTexture(gl::TEXTURE_BUFFER, m_textureID);
-        gl::TexBuffer(gl::TEXTURE_BUFFER, m_textureFormat, m_bufferID);
+        gl::BindTexture(gl::TEXTURE_BUFFER, m_regions[m_currentRegion].textureID);
         gl::Uniform1i(uniformLocation, texUnitIndex);
         GL_CHECK_ERRORS;
     }
 
+    void GLTextureBuffer::waitForFence(Region& region)
+    {
+        if (region.fence == nullptr)
+            return;
+
+        // Flush on the first wait only, so the fence is guaranteed to be signaled at some point
+        GLbitfield flags = gl::SYNC_FLUSH_COMMANDS_BIT;
+        while (true)
+        {
+            auto result = gl::ClientWaitSync(region.fence, flags, FENCE_TIMEOUT_NS);
+            if (result != gl::TIMEOUT_EXPIRED)
+                break;
+            flags = 0;
+        }
+        gl::DeleteSync(region.fence);
+        region.fence = nullptr;
+    }
+
+    void* GLTextureBuffer::map(size_t count, GLenum usageHint)
+    {
+        CC_ASSERT(count > 0)
+        m_currentRegion = (m_currentRegion + 1) % m_regions.size();
+        auto& region = m_regions[m_currentRegion];
+
+        gl::BindBuffer(gl::TEXTURE_BUFFER, region.bufferID);
+        GLbitfield access = gl::MAP_WRITE_BIT;
+        if (m_regions.size() == 1 || region.capacity < count)
+        {
+            // Orphan the storage: the GPU keeps reading the old one, while this gets fresh storage.
+            // Growing storage leaves some headroom, so it isn't reallocated again right away.
+            if (region.capacity < count)
+                region.capacity = std::max(count, region.capacity + region.capacity / 2);
+            gl::BufferData(gl::TEXTURE_BUFFER, region.capacity, nullptr, usageHint);
+            if (region.fence != nullptr)
+            {
+                gl::DeleteSync(region.fence);
+                region.fence = nullptr;
+            }
+            access |= gl::MAP_INVALIDATE_BUFFER_BIT;
+        }
+        else
+        {
+            // The GPU may only still be reading this region if the whole ring is in flight
+            waitForFence(region);
+            access |= gl::MAP_INVALIDATE_RANGE_BIT | gl::MAP_UNSYNCHRONIZED_BIT;
+        }
+
+        auto data = gl::MapBufferRange(gl::TEXTURE_BUFFER, 0, count, access);
+        gl::BindBuffer(gl::TEXTURE_BUFFER, 0);
+        GL_CHECK_ERRORS;
+        return data;
+    }
+
+    bool GLTextureBuffer::unmap()
+    {
+        gl::BindBuffer(gl::TEXTURE_BUFFER, m_regions[m_currentRegion].bufferID);
+        auto intact = gl::UnmapBuffer(gl::TEXTURE_BUFFER) != gl::FALSE_;
+        gl::BindBuffer(gl::TEXTURE_BUFFER, 0);
+        GL_CHECK_ERRORS;
+        return intact;
+    }
+
     void GLTextureBuffer::updateData(size_t count, const void *data, GLenum usageHint)
     {
-        gl::BindBuffer(gl::TEXTURE_BUFFER, m_bufferID);
+        if (count == 0)
+            return;
+
+        auto target = map(count, usageHint);
+        if (target != nullptr)
+        {
+            std::memcpy(target, data, count);
+            if (unmap())
+                return;
+        }
+
+        // Mapping failed or the mapped data was lost, copy the data the old-fashioned way
+        LOG_WARN("Could not map texture buffer, uploading " << count << " bytes with BufferSubData");
+        gl::BindBuffer(gl::TEXTURE_BUFFER, m_regions[m_currentRegion].bufferID);
         {
-            gl::BufferData(gl::TEXTURE_BUFFER, count, data, usageHint);
+            gl::BufferSubData(gl::TEXTURE_BUFFER, 0, count, data);
         }
         gl::BindBuffer(gl::TEXTURE_BUFFER, 0);
         GL_CHECK_ERRORS;
     }
+
+    void GLTextureBuffer::updateSubData(size_t offset, size_t count, const void *data)
+    {
+        CC_ASSERT(offset + count <= m_regions[m_currentRegion].capacity)
+        gl::BindBuffer(gl::TEXTURE_BUFFER, m_regions[m_currentRegion].bufferID);
+        {
+            gl::BufferSubData(gl::TEXTURE_BUFFER, offset, count, data);
+        }
+        gl::BindBuffer(gl::TEXTURE_BUFFER, 0);
+        GL_CHECK_ERRORS;
+    }
+
+    void GLTextureBuffer::fence()
+    {
+        // Orphaned storage is tracked by the driver
+        if (m_regions.size() == 1)
+            return;
+
+        auto& region = m_regions[m_currentRegion];
+        if (region.fence != nullptr)
+            gl::DeleteSync(region.fence);
+        region.fence = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
 }
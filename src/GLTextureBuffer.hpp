@@ -1,28 +1,61 @@
 #pragma once
 
+#include <vector>
+
 #include "gl_core_4_1.hpp"
 #include "NonCopyable.hpp"
 
 namespace cubedemo
 {
+    // A buffer texture, optionally backed by a ring of buffers for streaming data that changes every frame.
+    //
+    // With a single region, each update orphans the buffer storage and writes into the fresh storage.
+    // With several regions, each update writes into the next region of the ring without any synchronization
+    // by the driver, and storage is only reallocated when it has to grow. fence() has to be called after
+    // the draws that read a region, so it isn't overwritten before the GPU is done with it.
+    // Every region has its own buffer and texture, since GL 4.1 has no TexBufferRange to attach parts of one buffer.
     class GLTextureBuffer : NonCopyable
     {
     private:
-        GLuint m_textureID;
-        GLuint m_bufferID;
+        struct Region
+        {
+            GLuint textureID;
+            GLuint bufferID;
+            size_t capacity; // Size of the buffer storage, in bytes
+            GLsync fence; // Signaled once the GPU is done reading this region, or null
+        };
+
+        std::vector<Region> m_regions;
+        size_t m_currentRegion; // Region written by the last update, and used by bind
         GLenum m_textureFormat;
 
+        void waitForFence(Region& region); // Wait until the GPU is done reading a region
+
     public:
-	    explicit GLTextureBuffer(GLenum textureFormat); // textureFormat: GL_R32F, GL_RGB8I, etc
+        // textureFormat: GL_R32F, GL_RGB8I, etc
+        // regionCount: Amount of frames that can be in flight before updates wait for the GPU, 1 to orphan instead
+        explicit GLTextureBuffer(GLenum textureFormat, size_t regionCount = 1);
         ~GLTextureBuffer();
-        
-        inline GLuint texture() const { return m_textureID; }
-        inline GLuint buffer() const { return m_bufferID; }
+
+        inline GLuint texture() const { return m_regions[m_currentRegion].textureID; }
+        inline GLuint buffer() const { return m_regions[m_currentRegion].bufferID; }
 
         // Bind the texture to the given texture unit and update the corresponding uniform
         void bind(GLuint texUnitIndex, GLuint uniformLocation) const;
 
+        // Advance to the next region and map its first count (> 0) bytes for writing. The previous contents are undefined.
+        // Returns null if the buffer couldn't be mapped. Every successful map must be followed by unmap before drawing.
+        void* map(size_t count, GLenum usageHint = gl::DYNAMIC_DRAW);
+        bool unmap(); // Return false if the written data was lost, and has to be written again
+
         // Copy a given number of bytes into the texture buffer, with an optional gl usage hint
         void updateData(size_t count, const void *data, GLenum usageHint = gl::DYNAMIC_DRAW);
+
+        // Copy bytes into part of the current region, keeping the rest of its contents.
+        // Meant for single-region buffers that were filled with updateData before.
+        void updateSubData(size_t offset, size_t count, const void *data);
+
+        // Mark the current region as in use by all draws issued so far
+        void fence();
     };
 }
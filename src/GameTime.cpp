@@ -1,5 +1,7 @@
 #include "GameTime.hpp"
 
+#include <algorithm>
+
 using namespace std::chrono;
 
 namespace cubedemo
@@ -51,4 +53,46 @@ namespace cubedemo
 		m_lastUpdateTime = now;
 		return GameTimePoint(delta, total);
 	}
+
+	// // //
+	// FixedTimestep implementation
+	// // //
+
+	FixedTimestep::FixedTimestep(float frequency, int maxStepsPerFrame)
+		: m_stepSeconds{ 1.0f / frequency }, m_maxSteps{ maxStepsPerFrame },
+		m_frameTime{ 0.0f }, m_simulatedTime{ 0.0f }
+	{
+
+	}
+
+	void FixedTimestep::beginFrame(const GameTimePoint& frameTime)
+	{
+		m_frameTime = frameTime.total();
+
+		// Don't try to catch up after long stalls, drop the time instead
+		auto maxLag = m_maxSteps * m_stepSeconds;
+		if (m_frameTime - m_simulatedTime > maxLag)
+			m_simulatedTime = m_frameTime - maxLag;
+	}
+
+	bool FixedTimestep::nextStep(GameTimePoint& stepTime)
+	{
+		if (m_frameTime - m_simulatedTime < m_stepSeconds)
+			return false;
+
+		m_simulatedTime += m_stepSeconds;
+		stepTime = GameTimePoint(m_stepSeconds * 1000.0f, m_simulatedTime);
+		return true;
+	}
+
+	float FixedTimestep::alpha() const
+	{
+		return std::min(1.0f, std::max(0.0f, (m_frameTime - m_simulatedTime) / m_stepSeconds));
+	}
+
+	GameTimePoint FixedTimestep::interpolatedTime() const
+	{
+		auto total = m_simulatedTime - m_stepSeconds + alpha() * m_stepSeconds;
+		return GameTimePoint(0.0f, std::max(0.0f, total));
+	}
 }
@@ -40,4 +40,34 @@ namespace cubedemo
         // Return the current time point, and set this as the new "last update time"
         GameTimePoint nextTime();
     };
+
+    // Splits real time into simulation steps of a fixed length, independent of the frame rate
+    class FixedTimestep
+    {
+    private:
+        float m_stepSeconds; // Length of a simulation step, in seconds
+        int m_maxSteps; // Maximum steps per frame, anything beyond that is skipped
+        float m_frameTime; // Total time of the current frame, in seconds
+        float m_simulatedTime; // Total time the simulation has reached, in seconds
+
+    public:
+        // frequency: Simulation steps per second
+        // maxStepsPerFrame: Limits the work done after a long stall
+        explicit FixedTimestep(float frequency, int maxStepsPerFrame = 8);
+
+        // Return the length of a simulation step, in seconds
+        inline float stepSeconds() const { return m_stepSeconds; }
+
+        // Begin a new frame
+        void beginFrame(const GameTimePoint& frameTime);
+
+        // Return true and the time point of the next simulation step while the simulation lags behind the frame
+        bool nextStep(GameTimePoint& stepTime);
+
+        // Return the position of the current frame between the last two simulation steps, from 0 to 1
+        float alpha() const;
+
+        // Return the time point matching alpha, which is one step behind the frame time
+        GameTimePoint interpolatedTime() const;
+    };
 }
\ No newline at end of file
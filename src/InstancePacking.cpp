@@ -0,0 +1,174 @@
+#include "InstancePacking.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+#include "CpuFeatures.hpp"
+
+#ifdef CD_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace cubedemo
+{
+    static const float MIN_EXTENT = 1e-3f; // Keeps the quantization scale finite for a single instance
+    static const float UNORM16_MAX = 65535.0f;
+    static const float OPACITY_MAX = 16383.0f; // 14 bits, the lowest 2 bits of the texel hold the rotation index
+    static const float SQRT_2 = 1.4142136f;
+
+    static_assert(sizeof(CubeInstance) == 8 * sizeof(float), "CubeInstance must be 8 tightly packed floats");
+    static_assert(sizeof(CompactCubeInstance) == 8 * sizeof(uint16_t), "CompactCubeInstance must be 8 tightly packed 16 bit integers");
+    static_assert(sizeof(PositionCubeInstance) == 4 * sizeof(uint32_t), "PositionCubeInstance must be a single RGBA32UI texel");
+
+    // Positions and scales are quantized as (value - offset) * factor, lane by lane
+    struct PackingTransform
+    {
+        float offset[4];
+        float factor[4];
+    };
+
+    static PackingTransform packingTransform(const glm::vec3& origin, const glm::vec3& extent)
+    {
+        PackingTransform transform;
+        for (auto axis = 0; axis < 3; axis++)
+        {
+            transform.offset[axis] = origin[axis];
+            transform.factor[axis] = UNORM16_MAX / extent[axis];
+        }
+        transform.offset[3] = -MAX_INSTANCE_SCALE;
+        transform.factor[3] = UNORM16_MAX / (2.0f * MAX_INSTANCE_SCALE);
+        return transform;
+    }
+
+    static uint16_t quantize(float value, float max)
+    {
+        return uint16_t(std::nearbyint(std::min(max, std::max(0.0f, value))));
+    }
+
+    // Leaves out the largest quaternion component, which is rebuilt from the other three in the shader.
+    // Those are scaled from [-1/sqrt(2), 1/sqrt(2)] to the full range, rather than wasting bits on [-1, 1].
+    static void packRotationOpacity(const glm::vec4& rotationOpacity, uint16_t *out)
+    {
+        auto xyz = glm::vec3(rotationOpacity.x, rotationOpacity.y, rotationOpacity.z);
+        float quaternion[4] = { xyz.x, xyz.y, xyz.z, std::sqrt(std::max(0.0f, 1.0f - glm::dot(xyz, xyz))) };
+        auto largest = 3;
+        for (auto c = 0; c < 3; c++)
+        {
+            if (std::abs(quaternion[c]) > std::abs(quaternion[largest]))
+                largest = c;
+        }
+
+        // q and -q are the same rotation, pick the one where the left out component is positive
+        auto sign = quaternion[largest] < 0.0f ? -1.0f : 1.0f;
+        auto lane = 0;
+        for (auto c = 0; c < 4; c++)
+        {
+            if (c != largest)
+                out[lane++] = quantize((sign * quaternion[c] * SQRT_2 + 1.0f) * (UNORM16_MAX / 2.0f), UNORM16_MAX);
+        }
+        out[3] = uint16_t((quantize(rotationOpacity.w * OPACITY_MAX, OPACITY_MAX) << 2) | largest);
+    }
+
+    static void packCompactInstancesScalar(const CubeInstance *instances, size_t count, const PackingTransform& transform, CompactCubeInstance *out)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            auto source = &instances[i].positionScale.x;
+            for (auto lane = 0; lane < 4; lane++)
+                out[i].positionScale[lane] = quantize((source[lane] - transform.offset[lane]) * transform.factor[lane], UNORM16_MAX);
+            packRotationOpacity(instances[i].rotationOpacity, out[i].rotationOpacity);
+        }
+    }
+
+#ifdef CD_ARCH_X86
+    CD_TARGET_SSE2 static void packCompactInstancesSSE2(const CubeInstance *instances, size_t count, const PackingTransform& transform, CompactCubeInstance *out)
+    {
+        auto offset = _mm_loadu_ps(transform.offset);
+        auto factor = _mm_loadu_ps(transform.factor);
+        auto zero = _mm_setzero_ps();
+        auto max = _mm_set1_ps(UNORM16_MAX);
+
+        // SSE2 can only pack to signed 16 bit integers with saturation,
+        // so shift the values into the signed range and flip the sign bit back afterwards
+        auto bias = _mm_set1_epi32(32768);
+        auto signBits = _mm_set1_epi16(-32768);
+
+        // Only positions and scales are packed with SIMD, picking the left out quaternion component doesn't vectorize well
+        for (size_t i = 0; i < count; i++)
+        {
+            auto value = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&instances[i].positionScale.x), offset), factor);
+            value = _mm_min_ps(_mm_max_ps(value, zero), max);
+
+            auto integers = _mm_sub_epi32(_mm_cvtps_epi32(value), bias);
+            auto packed = _mm_xor_si128(_mm_packs_epi32(integers, integers), signBits);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out[i].positionScale), packed);
+            packRotationOpacity(instances[i].rotationOpacity, out[i].rotationOpacity);
+        }
+    }
+
+    CD_TARGET_SSE2 static void instanceBoundsSSE2(const CubeInstance *instances, size_t count, glm::vec3& min, glm::vec3& max)
+    {
+        auto lo = _mm_loadu_ps(&instances[0].positionScale.x);
+        auto hi = lo;
+        for (size_t i = 1; i < count; i++)
+        {
+            auto position = _mm_loadu_ps(&instances[i].positionScale.x);
+            lo = _mm_min_ps(lo, position);
+            hi = _mm_max_ps(hi, position);
+        }
+
+        float loValues[4], hiValues[4];
+        _mm_storeu_ps(loValues, lo);
+        _mm_storeu_ps(hiValues, hi);
+        min = glm::vec3(loValues[0], loValues[1], loValues[2]);
+        max = glm::vec3(hiValues[0], hiValues[1], hiValues[2]);
+    }
+#endif
+
+    void instanceBounds(const CubeInstance *instances, size_t count, glm::vec3& origin, glm::vec3& extent)
+    {
+        if (count == 0)
+        {
+            origin = glm::vec3(0.0f);
+            extent = glm::vec3(MIN_EXTENT);
+            return;
+        }
+
+        glm::vec3 min, max;
+#ifdef CD_ARCH_X86
+        if (simdLevel() >= SimdLevel::SSE2)
+            instanceBoundsSSE2(instances, count, min, max);
+        else
+#endif
+        {
+            min = max = glm::vec3(instances[0].positionScale);
+            for (size_t i = 1; i < count; i++)
+            {
+                for (auto axis = 0; axis < 3; axis++)
+                {
+                    min[axis] = std::min(min[axis], instances[i].positionScale[axis]);
+                    max[axis] = std::max(max[axis], instances[i].positionScale[axis]);
+                }
+            }
+        }
+
+        origin = min;
+        for (auto axis = 0; axis < 3; axis++)
+            extent[axis] = std::max(MIN_EXTENT, max[axis] - min[axis]);
+    }
+
+    void packCompactInstances(const CubeInstance *instances, size_t count, const glm::vec3& origin, const glm::vec3& extent, CompactCubeInstance *out)
+    {
+        auto transform = packingTransform(origin, extent);
+#ifdef CD_ARCH_X86
+        if (simdLevel() >= SimdLevel::SSE2)
+        {
+            packCompactInstancesSSE2(instances, count, transform, out);
+            return;
+        }
+#endif
+        packCompactInstancesScalar(instances, count, transform, out);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace cubedemo
+{
+    // Per-instance data of a rendered cube, as two RGBA32F texels
+    struct CubeInstance
+    {
+        glm::vec4 positionScale; // Center of the cube (xyz) and its scale (w)
+        glm::vec4 rotationOpacity; // Rotation quaternion without w, which is never negative (xyz), and the opacity (w)
+    };
+
+    // CubeInstance quantized to two RGBA16 (unsigned normalized) texels, half the size.
+    // Buffer textures have no signed normalized formats, so signed values are stored with an offset:
+    // positions relative to the bounds of all instances in the frame, and scales in [-MAX_INSTANCE_SCALE, MAX_INSTANCE_SCALE].
+    // Rotations are stored as the smallest three quaternion components, which lie in [-1/sqrt(2), 1/sqrt(2)].
+    // The largest one is rebuilt from them, its index is in the lowest 2 bits of the opacity, leaving 14 bits of opacity.
+    struct CompactCubeInstance
+    {
+        uint16_t positionScale[4];
+        uint16_t rotationOpacity[4];
+    };
+
+    // Per-frame data of a rendered cube whose rotation and scale are stored per slot, as one RGBA32UI texel
+    struct PositionCubeInstance
+    {
+        glm::vec3 position; // Center of the cube, read as float bits
+        uint32_t slotOpacity; // Slot of the cube in the upper 24 bits, opacity in the lower 8 bits
+    };
+
+    // Largest slot that can be stored in a PositionCubeInstance
+    const uint32_t MAX_INSTANCE_SLOT = (1u << 24) - 1;
+
+    inline uint32_t packSlotOpacity(uint32_t slot, float opacity)
+    {
+        return (slot << 8) | uint32_t(opacity * 255.0f + 0.5f);
+    }
+
+    // Largest scale that can be stored in a CompactCubeInstance, larger ones are clamped
+    const float MAX_INSTANCE_SCALE = 4.0f;
+
+    // The bounds of all instance positions, never thinner than a tiny minimum extent along any axis
+    void instanceBounds(const CubeInstance *instances, size_t count, glm::vec3& origin, glm::vec3& extent);
+
+    // Quantize instances, given the bounds of their positions
+    void packCompactInstances(const CubeInstance *instances, size_t count, const glm::vec3& origin, const glm::vec3& extent, CompactCubeInstance *out);
+}
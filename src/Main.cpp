@@ -7,12 +7,27 @@
 #include "Util.hpp"
 #include "CubeController.hpp"
 #include "CubeRenderer.hpp"
+#include "CubePipeline.hpp"
+#include "MeshFile.hpp"
 #include "TriangleBackground.hpp"
 #include "GameTime.hpp"
+#include "WorkerPool.hpp"
+#include "AllocationCounter.hpp"
 
 // Whether to limit rendering to 60 fps
 #define ENABLE_FRAMELIMITING
 
+// Cube simulation steps per second, independent of the frame rate
+static const float SIMULATION_RATE = 30.0f;
+
+// Frames after which all buffers have reached their final size, so frames must not allocate anymore
+static const int WARMUP_FRAMES = 60;
+
+// Cube mesh written by CubeMeshConverter, the build defines where
+#ifndef CUBEDEMO_MESH_FILE
+#define CUBEDEMO_MESH_FILE "rounded_cube.cmesh"
+#endif
+
 // Constants for initial window size
 static const size_t WINDOW_WIDTH = 1280;
 static const size_t WINDOW_HEIGHT = 720;
@@ -102,21 +117,44 @@ int main(int argc, char const *argv[])
     // Check for any errors so far
     GL_CHECK_ERRORS;
 
-    // Set up cubes
+    // Set up cubes, updated in parallel on all cores but the one of this thread, which is busy rendering
+    auto workerThreads = cubedemo::WorkerPool::defaultThreadCount();
+    cubedemo::WorkerPool workers{ workerThreads > 0 ? workerThreads - 1 : 0 };
+    LOG_INFO("Updating cubes on " << workers.concurrency() << " threads.");
     cubedemo::CubeController floatingCubes{ 3500 };
+    floatingCubes.setWorkerPool(&workers);
+    floatingCubes.setUpdateMode(cubedemo::CubeUpdateMode::Analytic);
+
+    // Load the cube mesh, with all its levels of detail
+    cubedemo::MeshFile cubeMesh;
+    if (!cubeMesh.open(CUBEDEMO_MESH_FILE) || cubeMesh.lodCount() != cubedemo::CUBE_MESH_LODS)
+    {
+        LOG_ERROR("Error loading the cube mesh from " << CUBEDEMO_MESH_FILE << ". Exiting.")
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
 
     // Set up renderers
-    globalRenderer = new cubedemo::CubeRenderer();
+    // Motion is computed on the GPU from data uploaded at spawn, and cubes are drawn sorted by depth so they blend correctly
+    globalRenderer = new cubedemo::CubeRenderer(cubeMesh, cubedemo::InstanceFormat::GpuHelix, cubedemo::CubeOrdering::Depth);
     auto *background = new cubedemo::TriangleBackground(7, 5);
 
     // Before starting main loop, make sure all window size callbacks are called
     windowResizeCallback(window, WINDOW_WIDTH, WINDOW_HEIGHT);
 
+    // Simulate cubes and build their frames on another thread, while this one draws
+    cubedemo::CubePipeline cubePipeline{ floatingCubes, globalRenderer->instanceFormat(), globalRenderer->instanceOrdering(), SIMULATION_RATE };
+
     cubedemo::GameTimer timer;
-    
+
     LOG_INFO("Entering main loop...");
+    if (cubedemo::allocationCountingEnabled())
+        LOG_INFO("Checking that frames don't allocate after " << WARMUP_FRAMES << " frames.");
+    auto frame = 0;
     while (!glfwWindowShouldClose(window))
     {
+        auto allocationsBefore = cubedemo::allocationCount();
         auto time = timer.nextTime();
 
         GL_CHECK_ERRORS;
@@ -124,7 +162,6 @@ int main(int argc, char const *argv[])
         gl::Clear(gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT);
 
         background->update(time); // Update background animations
-        floatingCubes.update(time); // Update cube states
 
         // Draw background without depth testing because
         // a) no overlap is possible
@@ -133,11 +170,17 @@ int main(int argc, char const *argv[])
         background->render(time); // Render background first
 
         gl::Enable(gl::DEPTH_TEST);
-        globalRenderer->update(time, floatingCubes); // Update renderer with new cube states
+        // Upload the cubes of the previous frame, while the ones of this frame are simulated
+        globalRenderer->upload(cubePipeline.nextFrame(time, globalRenderer->viewProjection()));
         globalRenderer->render(); // Render cubes
 
         GL_CHECK_ERRORS;
 
+        // Frame limiting and window system calls below are left out, they are beyond our control.
+        // The count only covers this thread, the pipeline checks its own thread.
+        if (++frame > WARMUP_FRAMES)
+            CC_ASSERT(cubedemo::allocationCount() == allocationsBefore)
+
 #ifdef ENABLE_FRAMELIMITING
         const float TARGET_TIME = 15.0f; // somewhat more than 60 fps
         while (timer.currentTime().timeSince(time) < TARGET_TIME)
@@ -0,0 +1,109 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+#ifdef _WIN32
+    MappedFile::MappedFile()
+        : m_data{ nullptr }, m_size{ 0 }, m_file{ INVALID_HANDLE_VALUE }, m_mapping{ nullptr }
+    {
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            LOG_ERROR("Could not open " << path << " for mapping");
+            close();
+            return false;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_data = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (m_data == nullptr)
+        {
+            LOG_ERROR("Could not map " << path);
+            close();
+            return false;
+        }
+        m_size = size_t(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data != nullptr)
+            UnmapViewOfFile(m_data);
+        if (m_mapping != nullptr)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+        m_data = nullptr;
+        m_size = 0;
+        m_file = INVALID_HANDLE_VALUE;
+        m_mapping = nullptr;
+    }
+#else
+    MappedFile::MappedFile()
+        : m_data{ nullptr }, m_size{ 0 }
+    {
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        // The mapping keeps its own reference to the file, so the descriptor can be closed right away.
+        // Empty files can't be mapped.
+        auto file = ::open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0)
+        {
+            LOG_ERROR("Could not open " << path << " for mapping");
+            if (file >= 0)
+                ::close(file);
+            return false;
+        }
+
+        auto data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (data == MAP_FAILED)
+        {
+            LOG_ERROR("Could not map " << path);
+            return false;
+        }
+        m_data = data;
+        m_size = size_t(status.st_size);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data != nullptr)
+            munmap(const_cast<void*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#include "NonCopyable.hpp"
+
+namespace cubedemo
+{
+    // A whole file mapped read-only into memory. Pages are only read from disk when they are touched,
+    // and are shared with the page cache instead of being copied onto the heap.
+    class MappedFile : NonCopyable
+    {
+    private:
+        const void *m_data; // Start of the mapping, or null if no file is open
+        size_t m_size; // Size of the file in bytes
+#ifdef _WIN32
+        void *m_file; // File and mapping handles
+        void *m_mapping;
+#endif
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // Map the file at the given path, closing any file mapped before. Logs an error and returns false on failure.
+        bool open(const std::string& path);
+        void close();
+
+        inline bool isOpen() const { return m_data != nullptr; }
+        inline const void* data() const { return m_data; }
+        inline size_t size() const { return m_size; }
+    };
+}
@@ -0,0 +1,208 @@
+// Converts Wavefront OBJ meshes into binary mesh files, see MeshFile.hpp.
+// Only positions, normals and faces are read. Faces with more than three vertices are split into fans,
+// and vertices with the same position and normal indices are shared.
+// Every level of detail is optimized for the vertex cache, overdraw and vertex fetches, see MeshOptimizer.hpp.
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+
+#include <glm/vec3.hpp>
+
+#include "Util.hpp"
+#include "CubeMesh.hpp"
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+
+using namespace cubedemo;
+
+struct ConverterOptions
+{
+    std::string inputPath;
+    std::string outputPath;
+    bool cubeLods = false; // Append the generated levels of detail of the cube mesh
+    bool optimize = true; // Run the mesh optimizer on every level of detail
+    MeshVertexFormat vertexFormat = MeshVertexFormat::Packed16;
+};
+
+// Names of the vertex formats on the command line, in the order of MeshVertexFormat
+static const char *VERTEX_FORMAT_NAMES[] = { "float32", "octahedral", "packed16" };
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options] INPUT.obj OUTPUT\n"
+        << "  --cube-lods         Use the input as the most detailed cube mesh, and append\n"
+        << "                      the generated levels of detail down to a plain box\n"
+        << "  --no-optimize       Keep the triangle and vertex order of the input\n"
+        << "  --vertex-format F   Vertex format of the output, one of\n"
+        << "                      float32     float positions and normals, 24 bytes per vertex\n"
+        << "                      octahedral  float positions, octahedral normals, 16 bytes per vertex\n"
+        << "                      packed16    16 bit positions and octahedral normals, 12 bytes per vertex (default)\n";
+}
+
+static bool parseOptions(int argc, char const *argv[], ConverterOptions& options)
+{
+    std::vector<std::string> paths;
+    for (auto i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (arg == "--cube-lods")
+            options.cubeLods = true;
+        else if (arg == "--no-optimize")
+            options.optimize = false;
+        else if (arg == "--vertex-format" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            auto found = std::find(std::begin(VERTEX_FORMAT_NAMES), std::end(VERTEX_FORMAT_NAMES), name);
+            if (found == std::end(VERTEX_FORMAT_NAMES))
+            {
+                LOG_ERROR("Unknown vertex format " << name);
+                return false;
+            }
+            options.vertexFormat = MeshVertexFormat(found - std::begin(VERTEX_FORMAT_NAMES));
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            LOG_ERROR("Unknown option " << arg);
+            return false;
+        }
+        else
+            paths.push_back(arg);
+    }
+
+    if (paths.size() != 2)
+        return false;
+    options.inputPath = paths[0];
+    options.outputPath = paths[1];
+    return true;
+}
+
+// Turn a 1-based or negative, relative OBJ index into a 0-based one. Returns false if it is out of range.
+static bool resolveIndex(long index, size_t count, size_t& resolved)
+{
+    if (index > 0 && size_t(index) <= count)
+        resolved = size_t(index - 1);
+    else if (index < 0 && size_t(-index) <= count)
+        resolved = count - size_t(-index);
+    else
+        return false;
+    return true;
+}
+
+static bool readObj(const std::string& path, Mesh& mesh)
+{
+    std::ifstream file{ path };
+    if (!file)
+    {
+        LOG_ERROR("Could not open " << path);
+        return false;
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::map<std::pair<size_t, size_t>, uint32_t> vertices; // Mesh vertex of each pair of position and normal indices
+
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        std::istringstream tokens{ line };
+        std::string type;
+        tokens >> type;
+        if (type == "v" || type == "vn")
+        {
+            glm::vec3 value;
+            if (!(tokens >> value.x >> value.y >> value.z))
+            {
+                LOG_ERROR(path << ":" << lineNumber << ": Expected three coordinates");
+                return false;
+            }
+            (type == "v" ? positions : normals).push_back(value);
+        }
+        else if (type == "f")
+        {
+            // Vertices are written as position/texcoord/normal, texture coordinates are ignored
+            std::vector<uint32_t> face;
+            std::string vertex;
+            while (tokens >> vertex)
+            {
+                auto firstSlash = vertex.find('/');
+                auto lastSlash = vertex.rfind('/');
+                size_t position, normal;
+                if (firstSlash == std::string::npos || lastSlash == firstSlash
+                    || !resolveIndex(std::strtol(vertex.c_str(), nullptr, 10), positions.size(), position)
+                    || !resolveIndex(std::strtol(vertex.c_str() + lastSlash + 1, nullptr, 10), normals.size(), normal))
+                {
+                    LOG_ERROR(path << ":" << lineNumber << ": Faces need valid position and normal indices");
+                    return false;
+                }
+
+                auto key = std::make_pair(position, normal);
+                auto found = vertices.find(key);
+                if (found == vertices.end())
+                {
+                    found = vertices.emplace(key, uint32_t(mesh.positions.size())).first;
+                    mesh.positions.push_back(positions[position]);
+                    mesh.normals.push_back(normals[normal]);
+                }
+                face.push_back(found->second);
+            }
+
+            if (face.size() < 3)
+            {
+                LOG_ERROR(path << ":" << lineNumber << ": Faces need at least three vertices");
+                return false;
+            }
+            for (size_t i = 2; i < face.size(); i++)
+                mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+        }
+    }
+
+    if (mesh.indices.empty())
+    {
+        LOG_ERROR(path << " contains no faces");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char const *argv[])
+{
+    ConverterOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Mesh mesh;
+    if (!readObj(options.inputPath, mesh))
+        return EXIT_FAILURE;
+
+    auto lods = options.cubeLods ? cubeMeshLods(mesh) : std::vector<Mesh>{ mesh };
+    for (size_t i = 0; i < lods.size(); i++)
+    {
+        auto& lod = lods[i];
+        auto before = analyzeVertexCache(lod.indices, lod.positions.size());
+        if (options.optimize)
+            optimizeMesh(lod);
+        auto after = analyzeVertexCache(lod.indices, lod.positions.size());
+        LOG_INFO("LOD " << i << ": " << lod.positions.size() << " vertices, " << lod.indices.size() / 3 << " triangles, "
+            << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr
+            << " (" << VERTEX_CACHE_SIZE << " entry FIFO cache)");
+    }
+
+    if (!writeMeshFile(options.outputPath, lods, options.vertexFormat))
+        return EXIT_FAILURE;
+    LOG_INFO("Wrote " << options.outputPath << " with " << VERTEX_FORMAT_NAMES[size_t(options.vertexFormat)] << " vertices, "
+        << meshVertexSize(options.vertexFormat) << " bytes each");
+    return EXIT_SUCCESS;
+}
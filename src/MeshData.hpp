@@ -1,21 +0,0 @@
-#pragma once
-
-#include <vector>
-
-namespace cubedemo
-{
-    const std::vector<float> ROUNDED_CUBE_VERTICES
-    {
-        0.939592f, 0.939592f, -0.939592f, 0.904951f, 0.952489f, -0.952489f, 0.912689f, 0.976974f, -0.912689f, 0.952489f, 0.952489f, -0.904951f, 0.870310f, 0.958346f, -0.958346f, 0.872890f, 0.987556f, -0.916204f, 0.000000f, 0.958346f, -0.958346f, 0.000000f, 0.987556f, -0.916204f, -0.870310f, 0.958346f, -0.958346f, -0.872890f, 0.987556f, -0.916204f, -0.904951f, 0.952489f, -0.952489f, -0.912689f, 0.976974f, -0.912689f, -0.939592f, 0.939592f, -0.939592f, -0.952489f, 0.952489f, -0.904951f, 0.916204f, 0.987556f, -0.872890f, 0.958346f, 0.958346f, -0.870310f, 0.874061f, 1.000000f, -0.874061f, 0.000000f, 1.000000f, -0.874061f, -0.874061f, 1.000000f, -0.874061f, -0.916204f, 0.987556f, -0.872890f, -0.958346f, 0.958346f, -0.870310f, 0.916204f, 0.987556f, 0.000000f, 0.958346f, 0.958346f, 0.000000f, 0.874061f, 1.000000f, 0.000000f, 0.000000f, 1.000000f, 0.000000f, -0.874061f, 1.000000f, 0.000000f, -0.916204f, 0.987556f, 0.000000f, -0.958346f, 0.958346f, 0.000000f, 0.916204f, 0.987556f, 0.872890f, 0.958346f, 0.958346f, 0.870310f, 0.874061f, 1.000000f, 0.874061f, 0.000000f, 1.000000f, 0.874061f, -0.874061f, 1.000000f, 0.874061f, -0.916204f, 0.987556f, 0.872890f, -0.958346f, 0.958346f, 0.870310f, 0.912689f, 0.976974f, 0.912689f, 0.952489f, 0.952489f, 0.904951f, 0.872890f, 0.987556f, 0.916204f, 0.000000f, 0.987556f, 0.916204f, -0.872890f, 0.987556f, 0.916204f, -0.912689f, 0.976974f, 0.912689f, -0.952489f, 0.952489f, 0.904951f, 0.904951f, 0.952489f, 0.952489f, 0.939592f, 0.939592f, 0.939592f, 0.870310f, 0.958346f, 0.958346f, 0.000000f, 0.958346f, 0.958346f, -0.870310f, 0.958346f, 0.958346f, -0.904951f, 0.952489f, 0.952489f, -0.939592f, 0.939592f, 0.939592f, -0.952489f, 0.904951f, -0.952489f, -0.976974f, 0.912689f, -0.912689f, -0.958346f, 0.870310f, -0.958346f, -0.987556f, 0.872890f, -0.916204f, -0.958346f, 0.000000f, -0.958346f, -0.987556f, 0.000000f, -0.916204f, -0.958346f, -0.870310f, -0.958346f, -0.987556f, -0.872890f, -0.916204f, -0.952489f, -0.904951f, -0.952489f, -0.976974f, -0.912689f, -0.912689f, -0.939592f, -0.939592f, -0.939592f, -0.952489f, -0.952489f, -0.904951f, -0.987556f, 0.916204f, -0.872890f, -1.000000f, 0.874061f, -0.874061f, -1.000000f, 0.000000f, -0.874061f, -1.000000f, -0.874061f, -0.874061f, -0.987556f, -0.916204f, -0.872890f, -0.958346f, -0.958346f, -0.870310f, -0.987556f, 0.916204f, 0.000000f, -1.000000f, 0.874061f, 0.000000f, -1.000000f, 0.000000f, 0.000000f, -1.000000f, -0.874061f, 0.000000f, -0.987556f, -0.916204f, 0.000000f, -0.958346f, -0.958346f, 0.000000f, -0.987556f, 0.916204f, 0.872890f, -1.000000f, 0.874061f, 0.874061f, -1.000000f, 0.000000f, 0.874061f, -1.000000f, -0.874061f, 0.874061f, -0.987556f, -0.916204f, 0.872890f, -0.958346f, -0.958346f, 0.870310f, -0.976974f, 0.912689f, 0.912689f, -0.987556f, 0.872890f, 0.916204f, -0.987556f, 0.000000f, 0.916204f, -0.987556f, -0.872890f, 0.916204f, -0.976974f, -0.912689f, 0.912689f, -0.952489f, -0.952489f, 0.904951f, -0.952489f, 0.904951f, 0.952489f, -0.958346f, 0.870310f, 0.958346f, -0.958346f, 0.000000f, 0.958346f, -0.958346f, -0.870310f, 0.958346f, -0.952489f, -0.904951f, 0.952489f, -0.939592f, -0.939592f, 0.939592f, -0.904951f, -0.952489f, -0.952489f, -0.912689f, -0.976974f, -0.912689f, -0.870310f, -0.958346f, -0.958346f, -0.872890f, -0.987556f, -0.916204f, 0.000000f, -0.958346f, -0.958346f, 0.000000f, -0.987556f, -0.916204f, 0.870310f, -0.958346f, -0.958346f, 0.872890f, -0.987556f, -0.916204f, 0.904951f, -0.952489f, -0.952489f, 0.912689f, -0.976974f, -0.912689f, 0.939592f, -0.939592f, -0.939592f, 0.952489f, -0.952489f, -0.904951f, -0.916204f, -0.987556f, -0.872890f, -0.874061f, -1.000000f, -0.874061f, 0.000000f, -1.000000f, -0.874061f, 0.874061f, -1.000000f, -0.874061f, 0.916204f, -0.987556f, -0.872890f, 0.958346f, -0.958346f, -0.870310f, -0.916204f, -0.987556f, 0.000000f, -0.874061f, -1.000000f, 0.000000f, 0.000000f, -1.000000f, 0.000000f, 0.874061f, -1.000000f, 0.000000f, 0.916204f, -0.987556f, 0.000000f, 0.958346f, -0.958346f, 0.000000f, -0.916204f, -0.987556f, 0.872890f, -0.874061f, -1.000000f, 0.874061f, 0.000000f, -1.000000f, 0.874061f, 0.874061f, -1.000000f, 0.874061f, 0.916204f, -0.987556f, 0.872890f, 0.958346f, -0.958346f, 0.870310f, -0.912689f, -0.976974f, 0.912689f, -0.872890f, -0.987556f, 0.916204f, 0.000000f, -0.987556f, 0.916204f, 0.872890f, -0.987556f, 0.916204f, 0.912689f, -0.976974f, 0.912689f, 0.952489f, -0.952489f, 0.904951f, -0.904951f, -0.952489f, 0.952489f, -0.870310f, -0.958346f, 0.958346f, 0.000000f, -0.958346f, 0.958346f, 0.870310f, -0.958346f, 0.958346f, 0.904951f, -0.952489f, 0.952489f, 0.939592f, -0.939592f, 0.939592f, 0.952489f, -0.904951f, -0.952489f, 0.976974f, -0.912689f, -0.912689f, 0.958346f, -0.870310f, -0.958346f, 0.987556f, -0.872890f, -0.916204f, 0.958346f, 0.000000f, -0.958346f, 0.987556f, 0.000000f, -0.916204f, 0.958346f, 0.870310f, -0.958346f, 0.987556f, 0.872890f, -0.916204f, 0.952489f, 0.904951f, -0.952489f, 0.976974f, 0.912689f, -0.912689f, 0.987556f, -0.916204f, -0.872890f, 1.000000f, -0.874061f, -0.874061f, 1.000000f, 0.000000f, -0.874061f, 1.000000f, 0.874061f, -0.874061f, 0.987556f, 0.916204f, -0.872890f, 0.987556f, -0.916204f, 0.000000f, 1.000000f, -0.874061f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 1.000000f, 0.874061f, 0.000000f, 0.987556f, 0.916204f, 0.000000f, 0.987556f, -0.916204f, 0.872890f, 1.000000f, -0.874061f, 0.874061f, 1.000000f, 0.000000f, 0.874061f, 1.000000f, 0.874061f, 0.874061f, 0.987556f, 0.916204f, 0.872890f, 0.976974f, -0.912689f, 0.912689f, 0.987556f, -0.872890f, 0.916204f, 0.987556f, 0.000000f, 0.916204f, 0.987556f, 0.872890f, 0.916204f, 0.976974f, 0.912689f, 0.912689f, 0.952489f, -0.904951f, 0.952489f, 0.958346f, -0.870310f, 0.958346f, 0.958346f, 0.000000f, 0.958346f, 0.958346f, 0.870310f, 0.958346f, 0.952489f, 0.904951f, 0.952489f, 0.912689f, -0.912689f, -0.976974f, 0.872890f, -0.916204f, -0.987556f, 0.000000f, -0.916204f, -0.987556f, -0.872890f, -0.916204f, -0.987556f, -0.912689f, -0.912689f, -0.976974f, 0.916204f, -0.872890f, -0.987556f, 0.874061f, -0.874061f, -1.000000f, 0.000000f, -0.874061f, -1.000000f, -0.874061f, -0.874061f, -1.000000f, -0.916204f, -0.872890f, -0.987556f, 0.916204f, 0.000000f, -0.987556f, 0.874061f, 0.000000f, -1.000000f, 0.000000f, 0.000000f, -1.000000f, -0.874061f, 0.000000f, -1.000000f, -0.916204f, 0.000000f, -0.987556f, 0.916204f, 0.872890f, -0.987556f, 0.874061f, 0.874061f, -1.000000f, 0.000000f, 0.874061f, -1.000000f, -0.874061f, 0.874061f, -1.000000f, -0.916204f, 0.872890f, -0.987556f, 0.912689f, 0.912689f, -0.976974f, 0.872890f, 0.916204f, -0.987556f, 0.000000f, 0.916204f, -0.987556f, -0.872890f, 0.916204f, -0.987556f, -0.912689f, 0.912689f, -0.976974f, 0.912689f, 0.912689f, 0.976974f, 0.872890f, 0.916204f, 0.987556f, 0.000000f, 0.916204f, 0.987556f, -0.872890f, 0.916204f, 0.987556f, -0.912689f, 0.912689f, 0.976974f, 0.916204f, 0.872890f, 0.987556f, 0.874061f, 0.874061f, 1.000000f, 0.000000f, 0.874061f, 1.000000f, -0.874061f, 0.874061f, 1.000000f, -0.916204f, 0.872890f, 0.987556f, 0.916204f, 0.000000f, 0.987556f, 0.874061f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 1.000000f, -0.874061f, 0.000000f, 1.000000f, -0.916204f, 0.000000f, 0.987556f, 0.916204f, -0.872890f, 0.987556f, 0.874061f, -0.874061f, 1.000000f, 0.000000f, -0.874061f, 1.000000f, -0.874061f, -0.874061f, 1.000000f, -0.916204f, -0.872890f, 0.987556f, 0.912689f, -0.912689f, 0.976974f, 0.872890f, -0.916204f, 0.987556f, 0.000000f, -0.916204f, 0.987556f, -0.872890f, -0.916204f, 0.987556f, -0.912689f, -0.912689f, 0.976974f
-    };
-
-    const std::vector<float> ROUNDED_CUBE_NORMALS
-    {
-        0.577349f, 0.577349f, -0.577349f, 0.359813f, 0.659719f, -0.659719f, 0.398419f, 0.826106f, -0.398419f, 0.659719f, 0.659719f, -0.359813f, 0.119938f, 0.701987f, -0.701987f, 0.131962f, 0.894345f, -0.427442f, 0.000000f, 0.707083f, -0.707083f, 0.000000f, 0.901914f, -0.431898f, -0.119938f, 0.701987f, -0.701987f, -0.131962f, 0.894345f, -0.427442f, -0.359813f, 0.659719f, -0.659719f, -0.398419f, 0.826106f, -0.398419f, -0.577349f, 0.577349f, -0.577349f, -0.659719f, 0.659719f, -0.359813f, 0.427442f, 0.894345f, -0.131962f, 0.701987f, 0.701987f, -0.119938f, 0.141636f, 0.979705f, -0.141636f, 0.000000f, 0.989685f, -0.143071f, -0.141636f, 0.979705f, -0.141636f, -0.427442f, 0.894345f, -0.131962f, -0.701987f, 0.701987f, -0.119938f, 0.431898f, 0.901914f, 0.000000f, 0.707083f, 0.707083f, 0.000000f, 0.143071f, 0.989685f, 0.000000f, 0.000000f, 1.000000f, 0.000000f, -0.143071f, 0.989685f, 0.000000f, -0.431898f, 0.901914f, 0.000000f, -0.707083f, 0.707083f, 0.000000f, 0.427442f, 0.894345f, 0.131962f, 0.701987f, 0.701987f, 0.119938f, 0.141636f, 0.979705f, 0.141636f, 0.000000f, 0.989685f, 0.143071f, -0.141636f, 0.979705f, 0.141636f, -0.427442f, 0.894345f, 0.131962f, -0.701987f, 0.701987f, 0.119938f, 0.398419f, 0.826106f, 0.398419f, 0.659719f, 0.659719f, 0.359813f, 0.131962f, 0.894345f, 0.427442f, 0.000000f, 0.901914f, 0.431898f, -0.131962f, 0.894345f, 0.427442f, -0.398419f, 0.826106f, 0.398419f, -0.659719f, 0.659719f, 0.359813f, 0.359813f, 0.659719f, 0.659719f, 0.577349f, 0.577349f, 0.577349f, 0.119938f, 0.701987f, 0.701987f, 0.000000f, 0.707083f, 0.707083f, -0.119938f, 0.701987f, 0.701987f, -0.359813f, 0.659719f, 0.659719f, -0.577349f, 0.577349f, 0.577349f, -0.659719f, 0.359813f, -0.659719f, -0.826106f, 0.398419f, -0.398419f, -0.701987f, 0.119938f, -0.701987f, -0.894345f, 0.131962f, -0.427442f, -0.707083f, 0.000000f, -0.707083f, -0.901914f, 0.000000f, -0.431898f, -0.701987f, -0.119938f, -0.701987f, -0.894345f, -0.131962f, -0.427442f, -0.659719f, -0.359813f, -0.659719f, -0.826106f, -0.398419f, -0.398419f, -0.577349f, -0.577349f, -0.577349f, -0.659719f, -0.659719f, -0.359813f, -0.894345f, 0.427442f, -0.131962f, -0.979705f, 0.141636f, -0.141636f, -0.989685f, 0.000000f, -0.143071f, -0.979705f, -0.141636f, -0.141636f, -0.894345f, -0.427442f, -0.131962f, -0.701987f, -0.701987f, -0.119938f, -0.901914f, 0.431898f, 0.000000f, -0.989685f, 0.143071f, 0.000000f, -1.000000f, 0.000000f, 0.000000f, -0.989685f, -0.143071f, 0.000000f, -0.901914f, -0.431898f, 0.000000f, -0.707083f, -0.707083f, 0.000000f, -0.894345f, 0.427442f, 0.131962f, -0.979705f, 0.141636f, 0.141636f, -0.989685f, 0.000000f, 0.143071f, -0.979705f, -0.141636f, 0.141636f, -0.894345f, -0.427442f, 0.131962f, -0.701987f, -0.701987f, 0.119938f, -0.826106f, 0.398419f, 0.398419f, -0.894345f, 0.131962f, 0.427442f, -0.901914f, 0.000000f, 0.431898f, -0.894345f, -0.131962f, 0.427442f, -0.826106f, -0.398419f, 0.398419f, -0.659719f, -0.659719f, 0.359813f, -0.659719f, 0.359813f, 0.659719f, -0.701987f, 0.119938f, 0.701987f, -0.707083f, 0.000000f, 0.707083f, -0.701987f, -0.119938f, 0.701987f, -0.659719f, -0.359813f, 0.659719f, -0.577349f, -0.577349f, 0.577349f, -0.359813f, -0.659719f, -0.659719f, -0.398419f, -0.826106f, -0.398419f, -0.119938f, -0.701987f, -0.701987f, -0.131962f, -0.894345f, -0.427442f, 0.000000f, -0.707083f, -0.707083f, 0.000000f, -0.901914f, -0.431898f, 0.119938f, -0.701987f, -0.701987f, 0.131962f, -0.894345f, -0.427442f, 0.359813f, -0.659719f, -0.659719f, 0.398419f, -0.826106f, -0.398419f, 0.577349f, -0.577349f, -0.577349f, 0.659719f, -0.659719f, -0.359813f, -0.427442f, -0.894345f, -0.131962f, -0.141636f, -0.979705f, -0.141636f, 0.000000f, -0.989685f, -0.143071f, 0.141636f, -0.979705f, -0.141636f, 0.427442f, -0.894345f, -0.131962f, 0.701987f, -0.701987f, -0.119938f, -0.431898f, -0.901914f, 0.000000f, -0.143071f, -0.989685f, 0.000000f, 0.000000f, -1.000000f, 0.000000f, 0.143071f, -0.989685f, 0.000000f, 0.431898f, -0.901914f, 0.000000f, 0.707083f, -0.707083f, 0.000000f, -0.427442f, -0.894345f, 0.131962f, -0.141636f, -0.979705f, 0.141636f, 0.000000f, -0.989685f, 0.143071f, 0.141636f, -0.979705f, 0.141636f, 0.427442f, -0.894345f, 0.131962f, 0.701987f, -0.701987f, 0.119938f, -0.398419f, -0.826106f, 0.398419f, -0.131962f, -0.894345f, 0.427442f, 0.000000f, -0.901914f, 0.431898f, 0.131962f, -0.894345f, 0.427442f, 0.398419f, -0.826106f, 0.398419f, 0.659719f, -0.659719f, 0.359813f, -0.359813f, -0.659719f, 0.659719f, -0.119938f, -0.701987f, 0.701987f, 0.000000f, -0.707083f, 0.707083f, 0.119938f, -0.701987f, 0.701987f, 0.359813f, -0.659719f, 0.659719f, 0.577349f, -0.577349f, 0.577349f, 0.659719f, -0.359813f, -0.659719f, 0.826106f, -0.398419f, -0.398419f, 0.701987f, -0.119938f, -0.701987f, 0.894345f, -0.131962f, -0.427442f, 0.707083f, 0.000000f, -0.707083f, 0.901914f, 0.000000f, -0.431898f, 0.701987f, 0.119938f, -0.701987f, 0.894345f, 0.131962f, -0.427442f, 0.659719f, 0.359813f, -0.659719f, 0.826106f, 0.398419f, -0.398419f, 0.894345f, -0.427442f, -0.131962f, 0.979705f, -0.141636f, -0.141636f, 0.989685f, 0.000000f, -0.143071f, 0.979705f, 0.141636f, -0.141636f, 0.894345f, 0.427442f, -0.131962f, 0.901914f, -0.431898f, 0.000000f, 0.989685f, -0.143071f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.989685f, 0.143071f, 0.000000f, 0.901914f, 0.431898f, 0.000000f, 0.894345f, -0.427442f, 0.131962f, 0.979705f, -0.141636f, 0.141636f, 0.989685f, 0.000000f, 0.143071f, 0.979705f, 0.141636f, 0.141636f, 0.894345f, 0.427442f, 0.131962f, 0.826106f, -0.398419f, 0.398419f, 0.894345f, -0.131962f, 0.427442f, 0.901914f, 0.000000f, 0.431898f, 0.894345f, 0.131962f, 0.427442f, 0.826106f, 0.398419f, 0.398419f, 0.659719f, -0.359813f, 0.659719f, 0.701987f, -0.119938f, 0.701987f, 0.707083f, 0.000000f, 0.707083f, 0.701987f, 0.119938f, 0.701987f, 0.659719f, 0.359813f, 0.659719f, 0.398419f, -0.398419f, -0.826106f, 0.131962f, -0.427442f, -0.894345f, 0.000000f, -0.431898f, -0.901914f, -0.131962f, -0.427442f, -0.894345f, -0.398419f, -0.398419f, -0.826106f, 0.427442f, -0.131962f, -0.894345f, 0.141636f, -0.141636f, -0.979705f, 0.000000f, -0.143071f, -0.989685f, -0.141636f, -0.141636f, -0.979705f, -0.427442f, -0.131962f, -0.894345f, 0.431898f, 0.000000f, -0.901914f, 0.143071f, 0.000000f, -0.989685f, 0.000000f, 0.000000f, -1.000000f, -0.143071f, 0.000000f, -0.989685f, -0.431898f, 0.000000f, -0.901914f, 0.427442f, 0.131962f, -0.894345f, 0.141636f, 0.141636f, -0.979705f, 0.000000f, 0.143071f, -0.989685f, -0.141636f, 0.141636f, -0.979705f, -0.427442f, 0.131962f, -0.894345f, 0.398419f, 0.398419f, -0.826106f, 0.131962f, 0.427442f, -0.894345f, 0.000000f, 0.431898f, -0.901914f, -0.131962f, 0.427442f, -0.894345f, -0.398419f, 0.398419f, -0.826106f, 0.398419f, 0.398419f, 0.826106f, 0.131962f, 0.427442f, 0.894345f, 0.000000f, 0.431898f, 0.901914f, -0.131962f, 0.427442f, 0.894345f, -0.398419f, 0.398419f, 0.826106f, 0.427442f, 0.131962f, 0.894345f, 0.141636f, 0.141636f, 0.979705f, 0.000000f, 0.143071f, 0.989685f, -0.141636f, 0.141636f, 0.979705f, -0.427442f, 0.131962f, 0.894345f, 0.431898f, 0.000000f, 0.901914f, 0.143071f, 0.000000f, 0.989685f, 0.000000f, 0.000000f, 1.000000f, -0.143071f, 0.000000f, 0.989685f, -0.431898f, 0.000000f, 0.901914f, 0.427442f, -0.131962f, 0.894345f, 0.141636f, -0.141636f, 0.979705f, 0.000000f, -0.143071f, 0.989685f, -0.141636f, -0.141636f, 0.979705f, -0.427442f, -0.131962f, 0.894345f, 0.398419f, -0.398419f, 0.826106f, 0.131962f, -0.427442f, 0.894345f, 0.000000f, -0.431898f, 0.901914f, -0.131962f, -0.427442f, 0.894345f, -0.398419f, -0.398419f, 0.826106f
-    };
-
-    const std::vector<unsigned int> ROUNDED_CUBE_INDICES
-    {
-        0, 1, 2, 0, 2, 3, 1, 4, 5, 1, 5, 2, 4, 6, 7, 4, 7, 5, 6, 8, 9, 6, 9, 7, 8, 10, 11, 8, 11, 9, 10, 12, 13, 10, 13, 11, 3, 2, 14, 3, 14, 15, 2, 5, 16, 2, 16, 14, 5, 7, 17, 5, 17, 16, 7, 9, 18, 7, 18, 17, 9, 11, 19, 9, 19, 18, 11, 13, 20, 11, 20, 19, 15, 14, 21, 15, 21, 22, 14, 16, 23, 14, 23, 21, 16, 17, 24, 16, 24, 23, 17, 18, 25, 17, 25, 24, 18, 19, 26, 18, 26, 25, 19, 20, 27, 19, 27, 26, 22, 21, 28, 22, 28, 29, 21, 23, 30, 21, 30, 28, 23, 24, 31, 23, 31, 30, 24, 25, 32, 24, 32, 31, 25, 26, 33, 25, 33, 32, 26, 27, 34, 26, 34, 33, 29, 28, 35, 29, 35, 36, 28, 30, 37, 28, 37, 35, 30, 31, 38, 30, 38, 37, 31, 32, 39, 31, 39, 38, 32, 33, 40, 32, 40, 39, 33, 34, 41, 33, 41, 40, 36, 35, 42, 36, 42, 43, 35, 37, 44, 35, 44, 42, 37, 38, 45, 37, 45, 44, 38, 39, 46, 38, 46, 45, 39, 40, 47, 39, 47, 46, 40, 41, 48, 40, 48, 47, 12, 49, 50, 12, 50, 13, 49, 51, 52, 49, 52, 50, 51, 53, 54, 51, 54, 52, 53, 55, 56, 53, 56, 54, 55, 57, 58, 55, 58, 56, 57, 59, 60, 57, 60, 58, 13, 50, 61, 13, 61, 20, 50, 52, 62, 50, 62, 61, 52, 54, 63, 52, 63, 62, 54, 56, 64, 54, 64, 63, 56, 58, 65, 56, 65, 64, 58, 60, 66, 58, 66, 65, 20, 61, 67, 20, 67, 27, 61, 62, 68, 61, 68, 67, 62, 63, 69, 62, 69, 68, 63, 64, 70, 63, 70, 69, 64, 65, 71, 64, 71, 70, 65, 66, 72, 65, 72, 71, 27, 67, 73, 27, 73, 34, 67, 68, 74, 67, 74, 73, 68, 69, 75, 68, 75, 74, 69, 70, 76, 69, 76, 75, 70, 71, 77, 70, 77, 76, 71, 72, 78, 71, 78, 77, 34, 73, 79, 34, 79, 41, 73, 74, 80, 73, 80, 79, 74, 75, 81, 74, 81, 80, 75, 76, 82, 75, 82, 81, 76, 77, 83, 76, 83, 82, 77, 78, 84, 77, 84, 83, 41, 79, 85, 41, 85, 48, 79, 80, 86, 79, 86, 85, 80, 81, 87, 80, 87, 86, 81, 82, 88, 81, 88, 87, 82, 83, 89, 82, 89, 88, 83, 84, 90, 83, 90, 89, 59, 91, 92, 59, 92, 60, 91, 93, 94, 91, 94, 92, 93, 95, 96, 93, 96, 94, 95, 97, 98, 95, 98, 96, 97, 99, 100, 97, 100, 98, 99, 101, 102, 99, 102, 100, 60, 92, 103, 60, 103, 66, 92, 94, 104, 92, 104, 103, 94, 96, 105, 94, 105, 104, 96, 98, 106, 96, 106, 105, 98, 100, 107, 98, 107, 106, 100, 102, 108, 100, 108, 107, 66, 103, 109, 66, 109, 72, 103, 104, 110, 103, 110, 109, 104, 105, 111, 104, 111, 110, 105, 106, 112, 105, 112, 111, 106, 107, 113, 106, 113, 112, 107, 108, 114, 107, 114, 113, 72, 109, 115, 72, 115, 78, 109, 110, 116, 109, 116, 115, 110, 111, 117, 110, 117, 116, 111, 112, 118, 111, 118, 117, 112, 113, 119, 112, 119, 118, 113, 114, 120, 113, 120, 119, 78, 115, 121, 78, 121, 84, 115, 116, 122, 115, 122, 121, 116, 117, 123, 116, 123, 122, 117, 118, 124, 117, 124, 123, 118, 119, 125, 118, 125, 124, 119, 120, 126, 119, 126, 125, 84, 121, 127, 84, 127, 90, 121, 122, 128, 121, 128, 127, 122, 123, 129, 122, 129, 128, 123, 124, 130, 123, 130, 129, 124, 125, 131, 124, 131, 130, 125, 126, 132, 125, 132, 131, 101, 133, 134, 101, 134, 102, 133, 135, 136, 133, 136, 134, 135, 137, 138, 135, 138, 136, 137, 139, 140, 137, 140, 138, 139, 141, 142, 139, 142, 140, 141, 0, 3, 141, 3, 142, 102, 134, 143, 102, 143, 108, 134, 136, 144, 134, 144, 143, 136, 138, 145, 136, 145, 144, 138, 140, 146, 138, 146, 145, 140, 142, 147, 140, 147, 146, 142, 3, 15, 142, 15, 147, 108, 143, 148, 108, 148, 114, 143, 144, 149, 143, 149, 148, 144, 145, 150, 144, 150, 149, 145, 146, 151, 145, 151, 150, 146, 147, 152, 146, 152, 151, 147, 15, 22, 147, 22, 152, 114, 148, 153, 114, 153, 120, 148, 149, 154, 148, 154, 153, 149, 150, 155, 149, 155, 154, 150, 151, 156, 150, 156, 155, 151, 152, 157, 151, 157, 156, 152, 22, 29, 152, 29, 157, 120, 153, 158, 120, 158, 126, 153, 154, 159, 153, 159, 158, 154, 155, 160, 154, 160, 159, 155, 156, 161, 155, 161, 160, 156, 157, 162, 156, 162, 161, 157, 29, 36, 157, 36, 162, 126, 158, 163, 126, 163, 132, 158, 159, 164, 158, 164, 163, 159, 160, 165, 159, 165, 164, 160, 161, 166, 160, 166, 165, 161, 162, 167, 161, 167, 166, 162, 36, 43, 162, 43, 167, 101, 99, 168, 101, 168, 133, 99, 97, 169, 99, 169, 168, 97, 95, 170, 97, 170, 169, 95, 93, 171, 95, 171, 170, 93, 91, 172, 93, 172, 171, 91, 59, 57, 91, 57, 172, 133, 168, 173, 133, 173, 135, 168, 169, 174, 168, 174, 173, 169, 170, 175, 169, 175, 174, 170, 171, 176, 170, 176, 175, 171, 172, 177, 171, 177, 176, 172, 57, 55, 172, 55, 177, 135, 173, 178, 135, 178, 137, 173, 174, 179, 173, 179, 178, 174, 175, 180, 174, 180, 179, 175, 176, 181, 175, 181, 180, 176, 177, 182, 176, 182, 181, 177, 55, 53, 177, 53, 182, 137, 178, 183, 137, 183, 139, 178, 179, 184, 178, 184, 183, 179, 180, 185, 179, 185, 184, 180, 181, 186, 180, 186, 185, 181, 182, 187, 181, 187, 186, 182, 53, 51, 182, 51, 187, 139, 183, 188, 139, 188, 141, 183, 184, 189, 183, 189, 188, 184, 185, 190, 184, 190, 189, 185, 186, 191, 185, 191, 190, 186, 187, 192, 186, 192, 191, 187, 51, 49, 187, 49, 192, 1, 0, 141, 1, 141, 188, 188, 189, 4, 188, 4, 1, 189, 190, 6, 189, 6, 4, 190, 191, 8, 190, 8, 6, 191, 192, 10, 191, 10, 8, 192, 49, 12, 192, 12, 10, 43, 42, 193, 43, 193, 167, 42, 44, 194, 42, 194, 193, 44, 45, 195, 44, 195, 194, 45, 46, 196, 45, 196, 195, 46, 47, 197, 46, 197, 196, 47, 48, 85, 47, 85, 197, 167, 193, 198, 167, 198, 166, 193, 194, 199, 193, 199, 198, 194, 195, 200, 194, 200, 199, 195, 196, 201, 195, 201, 200, 196, 197, 202, 196, 202, 201, 197, 85, 86, 197, 86, 202, 166, 198, 203, 166, 203, 165, 198, 199, 204, 198, 204, 203, 199, 200, 205, 199, 205, 204, 200, 201, 206, 200, 206, 205, 201, 202, 207, 201, 207, 206, 202, 86, 87, 202, 87, 207, 165, 203, 208, 165, 208, 164, 203, 204, 209, 203, 209, 208, 204, 205, 210, 204, 210, 209, 205, 206, 211, 205, 211, 210, 206, 207, 212, 206, 212, 211, 207, 87, 88, 207, 88, 212, 164, 208, 213, 164, 213, 163, 208, 209, 214, 208, 214, 213, 209, 210, 215, 209, 215, 214, 210, 211, 216, 210, 216, 215, 211, 212, 217, 211, 217, 216, 212, 88, 89, 212, 89, 217, 163, 213, 131, 163, 131, 132, 213, 214, 130, 213, 130, 131, 214, 215, 129, 214, 129, 130, 215, 216, 128, 215, 128, 129, 216, 217, 127, 216, 127, 128, 217, 89, 90, 217, 90, 127
-    };
-}
@@ -0,0 +1,227 @@
+#include "MeshFile.hpp"
+
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    static uint32_t alignOffset(size_t offset)
+    {
+        return uint32_t((offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT);
+    }
+
+    // Whether a block of count elements of the given size at offset lies within a file of fileSize bytes
+    static bool blockFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize)
+    {
+        return offset % MESH_FILE_ALIGNMENT == 0 && offset <= fileSize && count * size <= fileSize - offset;
+    }
+
+    // Signed normalized 16 bit value of v, clamped to [-1, 1]
+    static int16_t snorm16(float v)
+    {
+        return int16_t(std::lround(std::max(-1.0f, std::min(1.0f, v)) * 32767.0f));
+    }
+
+    // Project a normal onto the octahedron |x| + |y| + |z| = 1, and fold the lower half over the upper one
+    static void encodeOctahedral(const glm::vec3& normal, int16_t encoded[2])
+    {
+        auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        auto x = length > 0.0f ? normal.x / length : 0.0f;
+        auto y = length > 0.0f ? normal.y / length : 0.0f;
+        if (normal.z < 0.0f)
+        {
+            auto foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+        }
+        encoded[0] = snorm16(x);
+        encoded[1] = snorm16(y);
+    }
+
+    template<typename Index>
+    static bool indicesFit(const Index *indices, const MeshFileLod& lod)
+    {
+        for (auto i = lod.firstIndex; i < lod.firstIndex + lod.indexCount; i++)
+        {
+            if (indices[i] >= lod.vertexCount)
+                return false;
+        }
+        return true;
+    }
+
+    size_t meshVertexSize(MeshVertexFormat format)
+    {
+        switch (format)
+        {
+        case MeshVertexFormat::Float32:
+            return sizeof(MeshVertex);
+        case MeshVertexFormat::OctahedralNormals:
+            return sizeof(OctahedralMeshVertex);
+        case MeshVertexFormat::Packed16:
+            return sizeof(PackedMeshVertex);
+        default:
+            return 0;
+        }
+    }
+
+    bool writeMeshFile(const std::string& path, const std::vector<Mesh>& lods, MeshVertexFormat vertexFormat)
+    {
+        CC_ASSERT(meshVertexSize(vertexFormat) > 0)
+        MeshFileHeader header{};
+        header.magic = MESH_FILE_MAGIC;
+        header.version = MESH_FILE_VERSION;
+        header.vertexFormat = vertexFormat;
+        header.vertexStride = uint32_t(meshVertexSize(vertexFormat));
+        header.lodCount = uint32_t(lods.size());
+        header.positionScale = 1.0f;
+
+        std::vector<MeshFileLod> lodTable;
+        std::vector<MeshVertex> vertices;
+        std::vector<uint32_t> indices;
+        for (const auto& mesh : lods)
+        {
+            CC_ASSERT(mesh.positions.size() == mesh.normals.size() && mesh.indices.size() % 3 == 0)
+            lodTable.push_back(MeshFileLod{ uint32_t(indices.size()), uint32_t(mesh.indices.size()), uint32_t(vertices.size()), uint32_t(mesh.positions.size()) });
+            for (size_t i = 0; i < mesh.positions.size(); i++)
+                vertices.push_back(MeshVertex{ mesh.positions[i], mesh.normals[i] });
+            indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+        }
+        header.vertexCount = uint32_t(vertices.size());
+        header.indexCount = uint32_t(indices.size());
+
+        // Packed positions use the full signed normalized range
+        if (vertexFormat == MeshVertexFormat::Packed16)
+        {
+            auto maxCoordinate = 0.0f;
+            for (const auto& vertex : vertices)
+                maxCoordinate = std::max({ maxCoordinate, std::abs(vertex.position.x), std::abs(vertex.position.y), std::abs(vertex.position.z) });
+            header.positionScale = maxCoordinate > 0.0f ? maxCoordinate : 1.0f;
+        }
+
+        std::vector<char> vertexData(header.vertexStride * vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const auto& vertex = vertices[i];
+            auto target = &vertexData[header.vertexStride * i];
+            if (vertexFormat == MeshVertexFormat::OctahedralNormals)
+            {
+                OctahedralMeshVertex packed;
+                packed.position = vertex.position;
+                encodeOctahedral(vertex.normal, packed.normal);
+                std::memcpy(target, &packed, sizeof(packed));
+            }
+            else if (vertexFormat == MeshVertexFormat::Packed16)
+            {
+                PackedMeshVertex packed{};
+                packed.position[0] = snorm16(vertex.position.x / header.positionScale);
+                packed.position[1] = snorm16(vertex.position.y / header.positionScale);
+                packed.position[2] = snorm16(vertex.position.z / header.positionScale);
+                encodeOctahedral(vertex.normal, packed.normal);
+                std::memcpy(target, &packed, sizeof(packed));
+            }
+            else
+                std::memcpy(target, &vertex, sizeof(vertex));
+        }
+
+        // Indices count from the base vertex of their level of detail, so 16 bits are enough
+        // as long as no single level has more vertices than that
+        size_t maxLodVertices = 0;
+        for (const auto& lod : lodTable)
+            maxLodVertices = std::max(maxLodVertices, size_t(lod.vertexCount));
+        header.indexSize = maxLodVertices <= size_t(std::numeric_limits<uint16_t>::max()) + 1 ? sizeof(uint16_t) : sizeof(uint32_t);
+        std::vector<uint16_t> narrowIndices;
+        if (header.indexSize == sizeof(uint16_t))
+            narrowIndices.assign(indices.begin(), indices.end());
+
+        header.lodOffset = alignOffset(sizeof(header));
+        header.vertexOffset = alignOffset(header.lodOffset + sizeof(MeshFileLod) * lodTable.size());
+        header.indexOffset = alignOffset(header.vertexOffset + vertexData.size());
+        auto indexData = header.indexSize == sizeof(uint16_t) ? static_cast<const void*>(narrowIndices.data()) : indices.data();
+
+        std::ofstream file{ path, std::ios::binary };
+        if (!file)
+        {
+            LOG_ERROR("Could not open " << path << " for writing");
+            return false;
+        }
+
+        // Blocks are padded with zeros up to their offsets
+        auto write = [&](uint32_t offset, const void *data, size_t bytes)
+        {
+            static const char PADDING[MESH_FILE_ALIGNMENT] = {};
+            file.write(PADDING, std::streamsize(std::streamoff(offset) - std::streamoff(file.tellp())));
+            file.write(static_cast<const char*>(data), std::streamsize(bytes));
+        };
+        write(0, &header, sizeof(header));
+        write(header.lodOffset, lodTable.data(), sizeof(MeshFileLod) * lodTable.size());
+        write(header.vertexOffset, vertexData.data(), vertexData.size());
+        write(header.indexOffset, indexData, header.indexSize * indices.size());
+        if (!file)
+        {
+            LOG_ERROR("Could not write " << path);
+            return false;
+        }
+        return true;
+    }
+
+    // // //
+    // MeshFile implementation
+    // // //
+
+    MeshFile::MeshFile()
+        : m_header{ nullptr }, m_lods{ nullptr }
+    {
+    }
+
+    bool MeshFile::open(const std::string& path)
+    {
+        m_header = nullptr;
+        m_lods = nullptr;
+        if (!m_file.open(path))
+            return false;
+
+        // Everything is checked up front, so the blocks can be handed to GL without further checks
+        auto header = static_cast<const MeshFileHeader*>(m_file.data());
+        auto fileSize = uint64_t(m_file.size());
+        if (fileSize < sizeof(MeshFileHeader) || header->magic != MESH_FILE_MAGIC || header->version != MESH_FILE_VERSION)
+        {
+            LOG_ERROR(path << " is not a mesh file of version " << MESH_FILE_VERSION);
+            m_file.close();
+            return false;
+        }
+
+        auto valid = meshVertexSize(header->vertexFormat) > 0 && header->vertexStride == meshVertexSize(header->vertexFormat)
+            && header->positionScale > 0.0f
+            && (header->indexSize == sizeof(uint16_t) || header->indexSize == sizeof(uint32_t))
+            && blockFits(header->lodOffset, header->lodCount, sizeof(MeshFileLod), fileSize)
+            && blockFits(header->vertexOffset, header->vertexCount, header->vertexStride, fileSize)
+            && blockFits(header->indexOffset, header->indexCount, header->indexSize, fileSize);
+        auto lods = reinterpret_cast<const MeshFileLod*>(block(header->lodOffset));
+        for (uint32_t i = 0; valid && i < header->lodCount; i++)
+        {
+            const auto& lod = lods[i];
+            valid = lod.indexCount % 3 == 0
+                && uint64_t(lod.firstIndex) + lod.indexCount <= header->indexCount
+                && uint64_t(lod.baseVertex) + lod.vertexCount <= header->vertexCount;
+            if (valid && header->indexSize == sizeof(uint16_t))
+                valid = indicesFit(static_cast<const uint16_t*>(block(header->indexOffset)), lod);
+            else if (valid)
+                valid = indicesFit(static_cast<const uint32_t*>(block(header->indexOffset)), lod);
+        }
+        if (!valid)
+        {
+            LOG_ERROR(path << " is not a valid mesh file");
+            m_file.close();
+            return false;
+        }
+
+        m_header = header;
+        m_lods = lods;
+        return true;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+#include "NonCopyable.hpp"
+#include "MappedFile.hpp"
+#include "CubeMesh.hpp"
+
+namespace cubedemo
+{
+    // Binary mesh files hold every level of detail of a mesh in a form that can be uploaded to GL as is:
+    //   MeshFileHeader
+    //   MeshFileLod for each level of detail, most detailed first
+    //   Vertex block: vertexCount interleaved vertices, of all levels of detail
+    //   Index block: indexCount indices, of all levels of detail, each counting from the base vertex of its level
+    // Blocks start at multiples of MESH_FILE_ALIGNMENT. All values are little-endian.
+
+    const uint32_t MESH_FILE_MAGIC = 0x48534d43; // "CMSH"
+    const uint32_t MESH_FILE_VERSION = 2;
+    const size_t MESH_FILE_ALIGNMENT = 16;
+
+    // Layouts of the vertex block:
+    // Float32 - MeshVertex, 24 bytes per vertex
+    // OctahedralNormals - OctahedralMeshVertex, 16 bytes per vertex
+    // Packed16 - PackedMeshVertex, 12 bytes per vertex
+    enum class MeshVertexFormat : uint32_t
+    {
+        Float32,
+        OctahedralNormals,
+        Packed16,
+    };
+
+    struct MeshVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    // Normals are mapped onto an octahedron, whose lower half is folded over the upper one,
+    // and stored as its signed normalized x and y coordinates
+    struct OctahedralMeshVertex
+    {
+        glm::vec3 position;
+        int16_t normal[2];
+    };
+
+    // Positions are stored signed normalized, divided by the positionScale of the file. The fourth component is padding.
+    struct PackedMeshVertex
+    {
+        int16_t position[4];
+        int16_t normal[2];
+    };
+
+    struct MeshFileHeader
+    {
+        uint32_t magic; // MESH_FILE_MAGIC
+        uint32_t version; // MESH_FILE_VERSION
+        MeshVertexFormat vertexFormat;
+        uint32_t vertexStride; // Bytes per vertex
+        uint32_t vertexCount;
+        uint32_t indexSize; // Bytes per index, 2 or 4
+        uint32_t indexCount;
+        uint32_t lodCount;
+        uint32_t lodOffset; // Byte offsets of the blocks from the start of the file
+        uint32_t vertexOffset;
+        uint32_t indexOffset;
+        float positionScale; // Factor of the signed normalized positions of MeshVertexFormat::Packed16, 1 otherwise
+    };
+
+    struct MeshFileLod
+    {
+        uint32_t firstIndex; // Offset into the index block, in indices
+        uint32_t indexCount;
+        uint32_t baseVertex; // Offset into the vertex block, in vertices
+        uint32_t vertexCount;
+    };
+
+    static_assert(sizeof(MeshVertex) == 24 && sizeof(OctahedralMeshVertex) == 16 && sizeof(PackedMeshVertex) == 12
+        && sizeof(MeshFileHeader) == 48 && sizeof(MeshFileLod) == 16,
+        "Mesh file structures must not contain any padding");
+
+    // Bytes per vertex of a vertex format, 0 for unknown formats
+    size_t meshVertexSize(MeshVertexFormat format);
+
+    // Write the given levels of detail into a mesh file, with 16 bit indices if every level has few enough vertices.
+    // Logs an error and returns false on failure.
+    bool writeMeshFile(const std::string& path, const std::vector<Mesh>& lods, MeshVertexFormat vertexFormat = MeshVertexFormat::Packed16);
+
+    // A mesh file mapped into memory. The blocks point straight into the mapped pages.
+    class MeshFile : NonCopyable
+    {
+    private:
+        MappedFile m_file;
+        const MeshFileHeader *m_header; // Null if no valid file is open
+        const MeshFileLod *m_lods;
+
+        inline const void* block(uint32_t offset) const { return static_cast<const char*>(m_file.data()) + offset; }
+
+    public:
+        MeshFile();
+
+        // Map and validate the mesh file at the given path. Logs an error and returns false on failure.
+        bool open(const std::string& path);
+
+        inline bool isOpen() const { return m_header != nullptr; }
+        inline MeshVertexFormat vertexFormat() const { return m_header->vertexFormat; }
+        inline size_t vertexStride() const { return m_header->vertexStride; }
+        inline float positionScale() const { return m_header->positionScale; }
+        inline size_t vertexCount() const { return m_header->vertexCount; }
+        inline size_t indexSize() const { return m_header->indexSize; }
+        inline size_t indexCount() const { return m_header->indexCount; }
+        inline size_t lodCount() const { return m_header->lodCount; }
+        inline const MeshFileLod& lod(size_t index) const { return m_lods[index]; }
+
+        inline const void* vertices() const { return block(m_header->vertexOffset); }
+        inline size_t vertexBytes() const { return vertexStride() * vertexCount(); }
+        inline const void* indices() const { return block(m_header->indexOffset); }
+        inline size_t indexBytes() const { return indexSize() * indexCount(); }
+    };
+}
@@ -0,0 +1,284 @@
+#include "MeshOptimizer.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+namespace cubedemo
+{
+    // Parameters of Forsyth's vertex scores, for an LRU cache of FORSYTH_CACHE_SIZE entries
+    static const int FORSYTH_CACHE_SIZE = 32;
+    static const float CACHE_DECAY_POWER = 1.5f;
+    static const float LAST_TRIANGLE_SCORE = 0.75f;
+    static const float VALENCE_BOOST_SCALE = 2.0f;
+    static const float VALENCE_BOOST_POWER = 0.5f;
+
+    // How likely using a vertex next saves a vertex shader invocation, given its position in the LRU cache (-1 if not cached)
+    // and the amount of triangles still using it. Vertices used by few remaining triangles are preferred, so none are left behind.
+    static float forsythScore(int cachePosition, size_t remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.0f;
+
+        auto score = 0.0f;
+        if (cachePosition >= 0 && cachePosition < 3)
+            score = LAST_TRIANGLE_SCORE; // Used by the last triangle, equally good regardless of their order
+        else if (cachePosition >= 3)
+            score = std::pow(1.0f - float(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        return score + VALENCE_BOOST_SCALE * std::pow(float(remainingTriangles), -VALENCE_BOOST_POWER);
+    }
+
+    // Simulate a FIFO cache, calling miss(triangle) for every triangle whose vertices miss the cache
+    template<typename Miss>
+    static size_t simulateFifoCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, size_t cacheSize, const Miss& miss)
+    {
+        // A vertex is cached if it was inserted at most cacheSize insertions ago
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t insertions = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            auto vertex = indices[i];
+            if (insertedAt[vertex] == 0 || insertions - insertedAt[vertex] >= cacheSize)
+            {
+                insertedAt[vertex] = ++insertions;
+                miss(i / 3);
+            }
+        }
+        return insertions;
+    }
+
+    VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize)
+    {
+        auto misses = simulateFifoCache(indices.data(), indices.size(), vertexCount, cacheSize, [](size_t) {});
+        return VertexCacheStats{ float(misses) / std::max<size_t>(1, indices.size() / 3), float(misses) / std::max<size_t>(1, vertexCount) };
+    }
+
+    void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        auto triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // Triangles of each vertex that haven't been emitted yet, as ranges of one array.
+        // Emitted triangles are swapped to the end of the range of each of their vertices.
+        std::vector<size_t> remaining(vertexCount, 0);
+        for (auto vertex : indices)
+            remaining[vertex]++;
+        std::vector<size_t> firstTriangle(vertexCount + 1, 0);
+        std::partial_sum(remaining.begin(), remaining.end(), firstTriangle.begin() + 1);
+        std::vector<size_t> vertexTriangles(indices.size());
+        {
+            auto fill = firstTriangle;
+            for (size_t i = 0; i < indices.size(); i++)
+                vertexTriangles[fill[indices[i]]++] = i / 3;
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            vertexScore[v] = forsythScore(-1, remaining[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        for (size_t t = 0; t < triangleCount; t++)
+            triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+
+        std::vector<uint32_t> cache, nextCache;
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        auto best = size_t(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+        while (result.size() < indices.size())
+        {
+            // Without a candidate among the cached vertices, start over at the best remaining triangle
+            if (best == triangleCount)
+            {
+                auto bestScore = -std::numeric_limits<float>::max();
+                for (size_t t = 0; t < triangleCount; t++)
+                {
+                    if (!emitted[t] && triangleScore[t] > bestScore)
+                    {
+                        best = t;
+                        bestScore = triangleScore[t];
+                    }
+                }
+            }
+
+            emitted[best] = true;
+            const auto triangle = &indices[3 * best];
+            result.insert(result.end(), triangle, triangle + 3);
+            for (auto k = 0; k < 3; k++)
+            {
+                auto vertex = triangle[k];
+                auto begin = vertexTriangles.begin() + firstTriangle[vertex];
+                auto end = begin + remaining[vertex];
+                std::iter_swap(std::find(begin, end, best), end - 1);
+                remaining[vertex]--;
+            }
+
+            // The vertices of the new triangle move to the front of the cache, pushing the others back.
+            // Vertices pushed out of the cache get their scores updated as well.
+            nextCache.assign(triangle, triangle + 3);
+            for (auto vertex : cache)
+            {
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                    nextCache.push_back(vertex);
+            }
+            for (size_t n = 0; n < nextCache.size(); n++)
+            {
+                auto vertex = nextCache[n];
+                cachePosition[vertex] = n < size_t(FORSYTH_CACHE_SIZE) ? int(n) : -1;
+                vertexScore[vertex] = forsythScore(cachePosition[vertex], remaining[vertex]);
+            }
+
+            // Only triangles of updated vertices change their score, the best of those comes next
+            best = triangleCount;
+            auto bestScore = -std::numeric_limits<float>::max();
+            for (auto vertex : nextCache)
+            {
+                for (auto i = firstTriangle[vertex]; i < firstTriangle[vertex] + remaining[vertex]; i++)
+                {
+                    auto t = vertexTriangles[i];
+                    triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+                    if (triangleScore[t] > bestScore)
+                    {
+                        best = t;
+                        bestScore = triangleScore[t];
+                    }
+                }
+            }
+
+            nextCache.resize(std::min(nextCache.size(), size_t(FORSYTH_CACHE_SIZE)));
+            std::swap(cache, nextCache);
+        }
+
+        // Keep the original order if it was better already, like authored meshes exported as strips often are
+        if (analyzeVertexCache(result, vertexCount).acmr < analyzeVertexCache(indices, vertexCount).acmr)
+            indices.swap(result);
+    }
+
+    void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold)
+    {
+        auto triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // Hard cluster boundaries are at triangles that miss the cache with all their vertices, there the cache
+        // starts over anyway. Within those, clusters are split as soon as they reach a good enough miss ratio.
+        std::vector<size_t> triangleMisses(triangleCount, 0);
+        auto meshMisses = simulateFifoCache(indices.data(), indices.size(), positions.size(), VERTEX_CACHE_SIZE,
+            [&](size_t triangle) { triangleMisses[triangle]++; });
+        auto maxClusterAcmr = threshold * float(meshMisses) / triangleCount;
+
+        std::vector<size_t> clusters; // Index of the first triangle of each cluster
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            if (t == 0 || triangleMisses[t] == 3)
+                clusters.push_back(t);
+        }
+        clusters.push_back(triangleCount);
+
+        std::vector<size_t> splitClusters;
+        std::vector<size_t> clusterMisses;
+        for (size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            // Every cluster split off starts with an empty cache, as it may be drawn after any other cluster
+            auto begin = clusters[c];
+            auto hardEnd = clusters[c + 1];
+            while (begin < hardEnd)
+            {
+                splitClusters.push_back(begin);
+                clusterMisses.assign(hardEnd - begin, 0);
+                simulateFifoCache(&indices[3 * begin], 3 * (hardEnd - begin), positions.size(), VERTEX_CACHE_SIZE,
+                    [&](size_t triangle) { clusterMisses[triangle]++; });
+
+                size_t misses = 0;
+                auto end = begin;
+                while (end < hardEnd)
+                {
+                    misses += clusterMisses[end - begin];
+                    end++;
+                    if (end - begin > 1 && float(misses) / (end - begin) <= maxClusterAcmr)
+                        break;
+                }
+                begin = end;
+            }
+        }
+        splitClusters.push_back(triangleCount);
+
+        // Sort clusters by how far they face away from the area weighted centroid of the mesh
+        glm::vec3 meshCentroid{ 0.0f };
+        auto meshArea = 0.0f;
+        std::vector<glm::vec3> clusterCentroids(splitClusters.size() - 1, glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormals(splitClusters.size() - 1, glm::vec3(0.0f));
+        for (size_t cluster = 0; cluster + 1 < splitClusters.size(); cluster++)
+        {
+            auto clusterArea = 0.0f;
+            for (auto t = splitClusters[cluster]; t < splitClusters[cluster + 1]; t++)
+            {
+                const auto& a = positions[indices[3 * t]];
+                const auto& b = positions[indices[3 * t + 1]];
+                const auto& c = positions[indices[3 * t + 2]];
+                auto normal = glm::cross(b - a, c - a); // Twice the area along the normal
+                auto area = glm::length(normal);
+                auto centroid = (a + b + c) / 3.0f;
+                clusterCentroids[cluster] += centroid * area;
+                clusterNormals[cluster] += normal;
+                clusterArea += area;
+                meshCentroid += centroid * area;
+                meshArea += area;
+            }
+            clusterCentroids[cluster] /= std::max(clusterArea, std::numeric_limits<float>::min());
+        }
+        meshCentroid /= std::max(meshArea, std::numeric_limits<float>::min());
+
+        std::vector<float> clusterFacing(clusterNormals.size());
+        for (size_t c = 0; c < clusterNormals.size(); c++)
+        {
+            auto length = glm::length(clusterNormals[c]);
+            clusterFacing[c] = length > 0.0f ? glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / length) : 0.0f;
+        }
+
+        std::vector<size_t> order(clusterNormals.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return clusterFacing[a] > clusterFacing[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (auto c : order)
+            result.insert(result.end(), indices.begin() + 3 * splitClusters[c], indices.begin() + 3 * splitClusters[c + 1]);
+
+        // Clusters lose the vertices their predecessors left in the cache, so the whole mesh can still end up
+        // above the threshold. Convex meshes have little overdraw to save, so they are rather left alone then.
+        if (analyzeVertexCache(result, positions.size()).acmr <= maxClusterAcmr)
+            indices.swap(result);
+    }
+
+    void optimizeVertexFetch(Mesh& mesh)
+    {
+        static const auto UNUSED = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(mesh.positions.size(), UNUSED);
+        Mesh result;
+        for (auto& index : mesh.indices)
+        {
+            if (remap[index] == UNUSED)
+            {
+                remap[index] = uint32_t(result.positions.size());
+                result.positions.push_back(mesh.positions[index]);
+                result.normals.push_back(mesh.normals[index]);
+            }
+            index = remap[index];
+        }
+        mesh.positions.swap(result.positions);
+        mesh.normals.swap(result.normals);
+    }
+
+    void optimizeMesh(Mesh& mesh)
+    {
+        optimizeVertexCache(mesh.indices, mesh.positions.size());
+        optimizeOverdraw(mesh.indices, mesh.positions);
+        optimizeVertexFetch(mesh);
+    }
+}
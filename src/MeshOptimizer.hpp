@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+#include "CubeMesh.hpp"
+
+namespace cubedemo
+{
+    // Entries of the FIFO post-transform cache that vertex cache statistics are simulated with
+    const size_t VERTEX_CACHE_SIZE = 16;
+
+    // How often a mesh runs its vertex shader, given the order of its indices:
+    // acmr - Average cache miss ratio, vertex shader invocations per triangle. 0.5 at best for large regular meshes, 3 at worst.
+    // atvr - Average transformed vertex ratio, vertex shader invocations per vertex. 1 at best.
+    struct VertexCacheStats
+    {
+        float acmr;
+        float atvr;
+    };
+
+    VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+    // Reorder triangles so their vertices are likely still in the post-transform cache when they are used again,
+    // after Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Leaves the indices as they are if that is no improvement.
+    void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    // Reorder clusters of triangles from optimizeVertexCache, so triangles facing away from the center of the mesh
+    // come first and are more likely to occlude the others. Leaves the indices as they are if the cache miss ratio
+    // would get worse than threshold times the current one.
+    void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f);
+
+    // Reorder vertices in the order their indices are first used, so vertices are fetched mostly sequentially.
+    // Drops vertices that no triangle uses.
+    void optimizeVertexFetch(Mesh& mesh);
+
+    // Run all of the above, in that order
+    void optimizeMesh(Mesh& mesh);
+}
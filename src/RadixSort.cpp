@@ -0,0 +1,91 @@
+#include "RadixSort.hpp"
+
+#include <algorithm>
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    RadixSorter::RadixSorter()
+        : m_workers{ nullptr }
+    {
+    }
+
+    void RadixSorter::forEachRange(size_t count, const WorkerPool::RangeFunction& function)
+    {
+        // Chunks are always SORT_CHUNK_SIZE long, so per-chunk counts can be indexed by begin / SORT_CHUNK_SIZE
+        if (m_workers != nullptr)
+            m_workers->parallelFor(count, SORT_CHUNK_SIZE, function);
+        else
+        {
+            for (size_t begin = 0; begin < count; begin += SORT_CHUNK_SIZE)
+                function(begin, std::min(count, begin + SORT_CHUNK_SIZE));
+        }
+    }
+
+    void RadixSorter::reserve(size_t count)
+    {
+        if (m_pairs.size() >= count)
+            return;
+
+        m_pairs.resize(count);
+        m_sortedPairs.resize(count);
+        m_offsets.resize((count + SORT_CHUNK_SIZE - 1) / SORT_CHUNK_SIZE * RADIX);
+    }
+
+    void RadixSorter::sort(size_t count, uint32_t keyBits)
+    {
+        CC_ASSERT(count <= capacity() && keyBits <= 32)
+        if (count < 2)
+            return;
+
+        auto chunkCount = (count + SORT_CHUNK_SIZE - 1) / SORT_CHUNK_SIZE;
+
+        for (uint32_t shift = 0; shift < keyBits; shift += DIGIT_BITS)
+        {
+            auto pairs = m_pairs.data();
+            auto offsets = m_offsets.data();
+
+            // Count the digits of each chunk
+            forEachRange(count, [&](size_t begin, size_t end)
+            {
+                auto counts = offsets + begin / SORT_CHUNK_SIZE * RADIX;
+                std::fill(counts, counts + RADIX, 0u);
+                for (auto i = begin; i < end; i++)
+                    counts[(pairs[i].key >> shift) & (RADIX - 1)]++;
+            });
+
+            // Nothing moves if every key has the same digit, which is common for the highest digits
+            auto firstDigit = (pairs[0].key >> shift) & (RADIX - 1);
+            size_t firstDigitCount = 0;
+            for (size_t chunk = 0; chunk < chunkCount; chunk++)
+                firstDigitCount += offsets[chunk * RADIX + firstDigit];
+            if (firstDigitCount == count)
+                continue;
+
+            // Turn the counts into the first output position of each digit in each chunk:
+            // all smaller digits come first, then the same digit in earlier chunks
+            uint32_t position = 0;
+            for (uint32_t digit = 0; digit < RADIX; digit++)
+            {
+                for (size_t chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    auto& offset = offsets[chunk * RADIX + digit];
+                    auto digitCount = offset;
+                    offset = position;
+                    position += digitCount;
+                }
+            }
+
+            // Scatter every chunk to its offsets, keeping the order within each digit
+            auto sortedPairs = m_sortedPairs.data();
+            forEachRange(count, [&](size_t begin, size_t end)
+            {
+                auto chunkOffsets = offsets + begin / SORT_CHUNK_SIZE * RADIX;
+                for (auto i = begin; i < end; i++)
+                    sortedPairs[chunkOffsets[(pairs[i].key >> shift) & (RADIX - 1)]++] = pairs[i];
+            });
+            m_pairs.swap(m_sortedPairs);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "WorkerPool.hpp"
+#include "NonCopyable.hpp"
+#include "AlignedAllocator.hpp"
+
+namespace cubedemo
+{
+    // A key to sort by, and the value it carries
+    struct RadixPair
+    {
+        uint32_t key;
+        uint32_t value;
+    };
+
+    // Stable least significant digit radix sort of 32 bit keys, each carrying a 32 bit value.
+    // Every pass counts the digits of each chunk, turns the counts into per-chunk output offsets,
+    // and scatters each chunk independently, so passes run in parallel without any atomics.
+    // Passes in which every key has the same digit are skipped.
+    // Keys and values are interleaved, so scatters write one stream per digit instead of two.
+    class RadixSorter : NonCopyable
+    {
+    public:
+        static const size_t SORT_CHUNK_SIZE = 16384; // Pairs processed as one unit of work in parallel sorts
+        static const uint32_t DIGIT_BITS = 8; // Bits sorted per pass, 4 passes cover 32 bit keys
+        static const uint32_t RADIX = 1 << DIGIT_BITS;
+
+    private:
+        AlignedVector<RadixPair> m_pairs; // Pairs to sort, sorted after sort()
+        AlignedVector<RadixPair> m_sortedPairs; // Output of each pass, swapped with the input afterwards
+        AlignedVector<uint32_t> m_offsets; // RADIX digit counts per chunk, turned into output offsets
+
+        WorkerPool *m_workers; // Pool for parallel sorts, or null to sort on the calling thread
+
+        void forEachRange(size_t count, const WorkerPool::RangeFunction& function);
+
+    public:
+        RadixSorter();
+
+        // Sort on the given pool from now on (null to go back to single-threaded sorts)
+        inline void setWorkerPool(WorkerPool *workers) { m_workers = workers; }
+
+        // Make room for at least count pairs. Only allocates if the sorter has to grow.
+        void reserve(size_t count);
+        inline size_t capacity() const { return m_pairs.size(); }
+
+        // Storage for capacity() pairs, to be filled before sorting. Sorting moves it, so get it again afterwards.
+        inline RadixPair* pairs() { return m_pairs.data(); }
+        inline const RadixPair* pairs() const { return m_pairs.data(); }
+
+        // Sort the first count pairs by key, keeping pairs with equal keys in order.
+        // Keys must fit into keyBits bits, fewer bits need fewer passes.
+        void sort(size_t count, uint32_t keyBits = 32);
+    };
+}
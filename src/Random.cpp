@@ -0,0 +1,198 @@
+#include "Random.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace cubedemo
+{
+    // // //
+    // Philox4x32 implementation
+    // // //
+
+    static const uint32_t PHILOX_M0 = 0xD2511F53u;
+    static const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+    static const uint32_t PHILOX_W0 = 0x9E3779B9u;
+    static const uint32_t PHILOX_W1 = 0xBB67AE85u;
+    static const int PHILOX_ROUNDS = 10;
+
+    static inline void philoxRounds(uint32_t k0, uint32_t k1, uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t *out)
+    {
+        for (int round = 0; round < PHILOX_ROUNDS; round++)
+        {
+            auto p0 = uint64_t(PHILOX_M0) * c0;
+            auto p1 = uint64_t(PHILOX_M1) * c2;
+            c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+            c1 = uint32_t(p1);
+            c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+            c3 = uint32_t(p0);
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    void Philox4x32::generate(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4])
+    {
+        philoxRounds(key[0], key[1], counter[0], counter[1], counter[2], counter[3], out);
+    }
+
+    void Philox4x32::generateBlocks(const uint32_t key[2], const uint32_t counter[4], size_t count, uint32_t *out)
+    {
+        for (size_t i = 0; i < count; i++)
+            philoxRounds(key[0], key[1], counter[0] + uint32_t(i), counter[1], counter[2], counter[3], out + 4 * i);
+    }
+
+    // // //
+    // Ziggurat tables
+    // // //
+
+    static const int ZIGGURAT_LAYERS = 128;
+    static const double ZIGGURAT_R = 3.442619855899; // Start of the tail
+    static const double ZIGGURAT_V = 9.91256303526217e-3; // Area of each layer
+
+    struct ZigguratTables
+    {
+        uint32_t k[ZIGGURAT_LAYERS]; // Fast acceptance thresholds
+        float w[ZIGGURAT_LAYERS]; // Scale from integer to layer width
+        float f[ZIGGURAT_LAYERS]; // Density at the layer boundaries
+
+        ZigguratTables()
+        {
+            const double m = 2147483648.0;
+            double dn = ZIGGURAT_R, tn = dn;
+            double q = ZIGGURAT_V / exp(-0.5 * dn * dn);
+
+            k[0] = uint32_t((dn / q) * m);
+            k[1] = 0;
+            w[0] = float(q / m);
+            w[ZIGGURAT_LAYERS - 1] = float(dn / m);
+            f[0] = 1.0f;
+            f[ZIGGURAT_LAYERS - 1] = float(exp(-0.5 * dn * dn));
+
+            for (int i = ZIGGURAT_LAYERS - 2; i >= 1; i--)
+            {
+                dn = sqrt(-2.0 * log(ZIGGURAT_V / dn + exp(-0.5 * dn * dn)));
+                k[i + 1] = uint32_t((dn / tn) * m);
+                tn = dn;
+                f[i] = float(exp(-0.5 * dn * dn));
+                w[i] = float(dn / m);
+            }
+        }
+    };
+
+    static const ZigguratTables& zigguratTables()
+    {
+        static const ZigguratTables tables;
+        return tables;
+    }
+
+    // // //
+    // RandomStream implementation
+    // // //
+
+    RandomStream::RandomStream(uint64_t seed, uint64_t streamID)
+        : m_blockIndex{ 4 }
+    {
+        m_key[0] = uint32_t(seed);
+        m_key[1] = uint32_t(seed >> 32);
+        m_counter[0] = 0;
+        m_counter[1] = 0;
+        m_counter[2] = uint32_t(streamID);
+        m_counter[3] = uint32_t(streamID >> 32);
+    }
+
+    void RandomStream::nextBlock()
+    {
+        Philox4x32::generate(m_key, m_counter, m_block);
+        if (++m_counter[0] == 0)
+            m_counter[1]++;
+        m_blockIndex = 0;
+    }
+
+    uint32_t RandomStream::nextUInt()
+    {
+        if (m_blockIndex == 4)
+            nextBlock();
+        return m_block[m_blockIndex++];
+    }
+
+    static inline float toUnitFloat(uint32_t bits)
+    {
+        // 24 significant bits, centered in each interval so neither 0 nor 1 is possible
+        return (float(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+    }
+
+    float RandomStream::nextFloat()
+    {
+        return toUnitFloat(nextUInt());
+    }
+
+    float RandomStream::normal(float mean, float stddev)
+    {
+        const auto& tables = zigguratTables();
+
+        while (true)
+        {
+            auto hz = int32_t(nextUInt());
+            auto iz = hz & (ZIGGURAT_LAYERS - 1);
+            auto absHz = hz < 0 ? uint32_t(-int64_t(hz)) : uint32_t(hz);
+            auto x = float(hz) * tables.w[iz];
+
+            // Common case: inside the rectangular part of a layer
+            if (absHz < tables.k[iz])
+                return mean + stddev * x;
+
+            if (iz == 0)
+            {
+                // Sample from the tail beyond R
+                float tx, ty;
+                do
+                {
+                    tx = -std::log(nextFloat()) * float(1.0 / ZIGGURAT_R);
+                    ty = -std::log(nextFloat());
+                } while (ty + ty < tx * tx);
+                auto tail = float(ZIGGURAT_R) + tx;
+                return mean + stddev * (hz > 0 ? tail : -tail);
+            }
+
+            // Wedge between the rectangle and the curve
+            if (tables.f[iz] + nextFloat() * (tables.f[iz - 1] - tables.f[iz]) < std::exp(-0.5f * x * x))
+                return mean + stddev * x;
+        }
+    }
+
+    void RandomStream::fillUniform(float *out, size_t count, float lo, float hi)
+    {
+        // Generate whole blocks at once, in batches that fit on the stack
+        const size_t BATCH_BLOCKS = 64;
+        uint32_t words[4 * BATCH_BLOCKS];
+
+        while (count > 0)
+        {
+            auto blocks = std::min(BATCH_BLOCKS, (count + 3) / 4);
+            Philox4x32::generateBlocks(m_key, m_counter, blocks, words);
+            auto counter0 = m_counter[0];
+            m_counter[0] += uint32_t(blocks);
+            if (m_counter[0] < counter0)
+                m_counter[1]++;
+
+            auto n = std::min(count, 4 * blocks);
+            for (size_t i = 0; i < n; i++)
+                out[i] = lo + (hi - lo) * toUnitFloat(words[i]);
+            out += n;
+            count -= n;
+        }
+
+        // Don't hand out words from a block that was generated before the batch
+        m_blockIndex = 4;
+    }
+
+    void RandomStream::fillNormal(float *out, size_t count, float mean, float stddev)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = normal(mean, stddev);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace cubedemo
+{
+    // Counter-based random number generator (Philox4x32-10, Salmon et al. 2011).
+    // Every output block is a pure function of a key and a 128 bit counter, so any
+    // part of any stream can be computed independently on any thread, and the
+    // results are identical on every platform and standard library.
+    struct Philox4x32 final
+    {
+        // Compute the four random words for one counter value
+        static void generate(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+
+        // Compute count consecutive blocks, starting at the given counter and incrementing its first word.
+        // The blocks are independent, which allows the compiler to vectorize this loop.
+        static void generateBlocks(const uint32_t key[2], const uint32_t counter[4], size_t count, uint32_t *out);
+    };
+
+    // A stream of random numbers, identified by a seed and a stream id.
+    // Streams with different ids are statistically independent.
+    class RandomStream final
+    {
+    private:
+        uint32_t m_key[2];
+        uint32_t m_counter[4];
+        uint32_t m_block[4]; // Current output block
+        int m_blockIndex; // Next unused word in m_block
+
+        void nextBlock();
+
+    public:
+        RandomStream(uint64_t seed, uint64_t streamID);
+
+        // Uniformly distributed 32 bit integer
+        uint32_t nextUInt();
+
+        // Uniform float in (0, 1), never exactly 0 or 1
+        float nextFloat();
+
+        // Uniform float in (lo, hi)
+        inline float uniform(float lo, float hi) { return lo + (hi - lo) * nextFloat(); }
+
+        // Either 1 or -1, with equal probability
+        inline float sign() { return (nextUInt() & 0x80000000u) ? -1.0f : 1.0f; }
+
+        // Normally distributed float, sampled with the Ziggurat method (Marsaglia & Tsang 2000)
+        float normal(float mean, float stddev);
+
+        // Batched versions of uniform and normal
+        void fillUniform(float *out, size_t count, float lo, float hi);
+        void fillNormal(float *out, size_t count, float mean, float stddev);
+    };
+}
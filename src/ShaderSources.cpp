@@ -6,16 +6,43 @@ static const char *SHADER_SOURCE_CUBES_VERT = ""
 LN("#version 410")
 LN("")
 LN("in vec3 position;")
+LN("#ifdef OCTAHEDRAL_NORMALS")
+LN("in vec2 normal; // Folded octahedron coordinates, see MeshFile.hpp")
+LN("#else")
 LN("in vec3 normal;")
+LN("#endif")
 LN("")
 LN("out vec3 fragPosition;")
 LN("out vec3 fragNormal;")
 LN("out float fragOpacity;")
 LN("")
-LN("uniform samplerBuffer InstancePositions;")
-LN("uniform samplerBuffer InstanceOpacities;")
-LN("uniform samplerBuffer InstanceScales;")
-LN("uniform samplerBuffer InstanceRotations;")
+LN("#if defined(GPU_HELIX)")
+LN("// Three texels per slot: helix origin (xyz) and radius (w),")
+LN("// helix height per revolution, phase, start time and age at which the cube fades out,")
+LN("// rotation axis times rotation speed (xyz) and scale (w)")
+LN("uniform samplerBuffer InstanceSlots;")
+LN("uniform float Time;")
+LN("uniform float FadeSeconds;")
+LN("uniform float HelixTimeScale;")
+LN("#ifdef SORTED_SLOTS")
+LN("uniform usamplerBuffer Instances; // Slot of each instance, in drawing order")
+LN("#endif")
+LN("#elif defined(STATIC_ROTATION)")
+LN("uniform usamplerBuffer Instances; // Position bits (xyz), slot and 8 bit opacity (w)")
+LN("uniform samplerBuffer InstanceSlots; // Per slot: rotation axis times rotation speed (xyz), scale (w)")
+LN("uniform float Time;")
+LN("#else")
+LN("uniform samplerBuffer Instances; // Two texels per instance: position and scale, rotation xyz and opacity")
+LN("#endif")
+LN("#ifdef COMPACT_INSTANCES")
+LN("uniform vec3 InstanceOrigin; // Bounds of the quantized positions")
+LN("uniform vec3 InstanceExtent;")
+LN("uniform float InstanceMaxScale; // Range of the quantized scales")
+LN("#endif")
+LN("#ifdef PACKED_POSITIONS")
+LN("uniform float PositionScale; // Factor of the signed normalized positions")
+LN("#endif")
+LN("uniform int InstanceOffset; // Index of the first instance of the draw, GL 4.1 has no base instance")
 LN("uniform mat4 ModelViewMatrix;")
 LN("uniform mat4 ProjectionMatrix;")
 LN("uniform mat4 MVP;")
@@ -26,16 +53,99 @@ LN("{")
 LN("    return pos + 2.0 * cross(cross(pos, quat.xyz) + quat.w * pos, quat.xyz);")
 LN("}")
 LN("")
+LN("#ifdef OCTAHEDRAL_NORMALS")
+LN("vec3 octahedral_decode(vec2 encoded)")
+LN("{")
+LN("    // Unfold the lower half of the octahedron")
+LN("    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));")
+LN("    float fold = max(-n.z, 0.0);")
+LN("    n.xy += vec2(n.x >= 0.0 ? -fold : fold, n.y >= 0.0 ? -fold : fold);")
+LN("    return normalize(n);")
+LN("}")
+LN("#endif")
+LN("")
+LN("#if defined(GPU_HELIX) || defined(STATIC_ROTATION)")
+LN("// Rotation after spinning around an axis for some time, given the axis times the rotation speed")
+LN("vec4 spin_rotation(vec3 spin, float time)")
+LN("{")
+LN("    float speed = length(spin);")
+LN("    float halfAngle = 0.5 * time * speed;")
+LN("    return speed > 0.0 ? vec4(spin / speed * sin(halfAngle), cos(halfAngle)) : vec4(0.0, 0.0, 0.0, 1.0);")
+LN("}")
+LN("#endif")
+LN("")
 LN("void main()")
 LN("{")
-LN("    vec3 instanceOffset = texelFetch(InstancePositions, gl_InstanceID).xyz;")
-LN("    float instanceOpacity = texelFetch(InstanceOpacities, gl_InstanceID).r;")
-LN("    float instanceScale = texelFetch(InstanceScales, gl_InstanceID).x;")
-LN("    vec4 instanceRotation = texelFetch(InstanceRotations, gl_InstanceID);")
+LN("    int instance = gl_InstanceID + InstanceOffset;")
+LN("#if defined(GPU_HELIX)")
+LN("#ifdef SORTED_SLOTS")
+LN("    int slot = int(texelFetch(Instances, instance).r);")
+LN("#else")
+LN("    // Every slot is drawn, the instance index is the slot")
+LN("    int slot = instance;")
+LN("#endif")
+LN("    vec4 helixOrigin = texelFetch(InstanceSlots, 3 * slot);")
+LN("    vec4 helixTimes = texelFetch(InstanceSlots, 3 * slot + 1);")
+LN("    vec4 spin = texelFetch(InstanceSlots, 3 * slot + 2);")
+LN("")
+LN("    float age = Time - helixTimes.z;")
+LN("    float t = HelixTimeScale * age;")
+LN("    float phase = t * 6.28318531 + helixTimes.y;")
+LN("    vec3 instanceOffset = helixOrigin.xyz + vec3(helixOrigin.w * cos(phase), helixTimes.x * t, helixOrigin.w * sin(phase));")
+LN("    float instanceOpacity = clamp(min(age, helixTimes.w + FadeSeconds - age) / FadeSeconds, 0.0, 1.0);")
+LN("")
+LN("    // Dead and unused slots collapse to a point, so they produce no fragments")
+LN("    float instanceScale = instanceOpacity > 0.0 ? spin.w : 0.0;")
+LN("    vec4 instanceRotation = spin_rotation(spin.xyz, Time);")
+LN("#elif defined(STATIC_ROTATION)")
+LN("    uvec4 record = texelFetch(Instances, instance);")
+LN("    vec4 spin = texelFetch(InstanceSlots, int(record.w >> 8));")
 LN("")
-LN("    vec3 offsetPosition = quaternion_rotation(position * instanceScale, instanceRotation) + instanceOffset;")
+LN("    vec3 instanceOffset = uintBitsToFloat(record.xyz);")
+LN("    float instanceScale = spin.w;")
+LN("    float instanceOpacity = float(record.w & 255u) / 255.0;")
+LN("    vec4 instanceRotation = spin_rotation(spin.xyz, Time);")
+LN("#else")
+LN("    vec4 positionScale = texelFetch(Instances, 2 * instance);")
+LN("    vec4 rotationOpacity = texelFetch(Instances, 2 * instance + 1);")
 LN("")
-LN("    fragNormal = normalize(NormalMatrix * quaternion_rotation(normal, instanceRotation));")
+LN("#ifdef COMPACT_INSTANCES")
+LN("    // Unsigned normalized values, signed ones are stored with an offset")
+LN("    positionScale = vec4(InstanceOrigin + positionScale.xyz * InstanceExtent, (positionScale.w * 2.0 - 1.0) * InstanceMaxScale);")
+LN("    // The smallest three quaternion components, scaled up from [-1/sqrt(2), 1/sqrt(2)].")
+LN("    // The index of the largest one is in the lowest 2 bits of the 14 bit opacity.")
+LN("    uint rotationBits = uint(rotationOpacity.w * 65535.0 + 0.5);")
+LN("    vec3 smallest = (rotationOpacity.xyz * 2.0 - 1.0) * 0.70710678;")
+LN("    float largest = sqrt(max(0.0, 1.0 - dot(smallest, smallest)));")
+LN("    uint largestIndex = rotationBits & 3u;")
+LN("    vec4 instanceRotation = largestIndex == 0u ? vec4(largest, smallest)")
+LN("        : largestIndex == 1u ? vec4(smallest.x, largest, smallest.yz)")
+LN("        : largestIndex == 2u ? vec4(smallest.xy, largest, smallest.z)")
+LN("        : vec4(smallest, largest);")
+LN("    float instanceOpacity = float(rotationBits >> 2u) / 16383.0;")
+LN("#else")
+LN("    float instanceOpacity = rotationOpacity.w;")
+LN("    vec4 instanceRotation = vec4(rotationOpacity.xyz, sqrt(max(0.0, 1.0 - dot(rotationOpacity.xyz, rotationOpacity.xyz))));")
+LN("#endif")
+LN("")
+LN("    vec3 instanceOffset = positionScale.xyz;")
+LN("    float instanceScale = positionScale.w;")
+LN("#endif")
+LN("")
+LN("#ifdef PACKED_POSITIONS")
+LN("    vec3 basePosition = position * PositionScale;")
+LN("#else")
+LN("    vec3 basePosition = position;")
+LN("#endif")
+LN("#ifdef OCTAHEDRAL_NORMALS")
+LN("    vec3 baseNormal = octahedral_decode(normal);")
+LN("#else")
+LN("    vec3 baseNormal = normal;")
+LN("#endif")
+LN("")
+LN("    vec3 offsetPosition = quaternion_rotation(basePosition * instanceScale, instanceRotation) + instanceOffset;")
+LN("")
+LN("    fragNormal = normalize(NormalMatrix * quaternion_rotation(baseNormal, instanceRotation));")
 LN("    fragPosition = vec3(ModelViewMatrix * vec4(offsetPosition, 1.0));")
 LN("    fragOpacity = instanceOpacity;")
 LN("")
@@ -127,6 +237,18 @@ LN("");
 static const char *SHADER_SOURCE_HDRBLOOM_VERT = "";
 static const char *SHADER_SOURCE_HDRBLOOM_FRAG = "";
 
+std::string cubedemo::shaderSourceWithDefines(const char *source, const std::vector<const char*>& defines)
+{
+    // Defines have to follow the #version line, which must come first
+    std::string result{ source };
+    auto insertAt = result.find('\n') + 1;
+    std::string defineLines;
+    for (auto define : defines)
+        defineLines += std::string("#define ") + define + "\n";
+    result.insert(insertAt, defineLines);
+    return result;
+}
+
 const char* cubedemo::shaderSourceCubesVert()
 {
     return SHADER_SOURCE_CUBES_VERT;
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 namespace cubedemo
 {
+    // Insert a #define for each of the given names into a shader source, right after its #version line
+    std::string shaderSourceWithDefines(const char *source, const std::vector<const char*>& defines);
+
     const char* shaderSourceCubesVert();
     const char* shaderSourceCubesFrag();
 
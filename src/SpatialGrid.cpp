@@ -0,0 +1,235 @@
+#include "SpatialGrid.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    SpatialGrid::SpatialGrid(float cellSize)
+        : m_requestedCellSize{ cellSize }, m_cellSize{ cellSize }, m_origin{ 0.0f },
+        m_dimensions{ 0, 0, 0 }, m_maxRadius{ 0.0f }, m_cellCursorCapacity{ 0 }, m_workers{ nullptr }
+    {
+        CC_ASSERT(cellSize > 0.0f)
+        m_cellStarts.assign(1, 0);
+    }
+
+    void SpatialGrid::forEachRange(size_t count, const WorkerPool::RangeFunction& function)
+    {
+        // Chunks are always BUILD_CHUNK_SIZE long, so per-chunk results can be indexed by begin / BUILD_CHUNK_SIZE
+        if (m_workers != nullptr)
+            m_workers->parallelFor(count, BUILD_CHUNK_SIZE, function);
+        else
+        {
+            for (size_t begin = 0; begin < count; begin += BUILD_CHUNK_SIZE)
+                function(begin, std::min(count, begin + BUILD_CHUNK_SIZE));
+        }
+    }
+
+    void SpatialGrid::cellCoordinates(const glm::vec3& point, int coordinates[3]) const
+    {
+        // Clamping before the conversion keeps huge values in range, and makes truncation round down
+        auto relative = (point - m_origin) * (1.0f / m_cellSize);
+        for (auto axis = 0; axis < 3; axis++)
+            coordinates[axis] = int(std::min(std::max(0.0f, relative[axis]), float(m_dimensions[axis] - 1)));
+    }
+
+    void SpatialGrid::rebuild(const CubeController& cubes)
+    {
+        auto count = cubes.aliveCount();
+        auto indices = cubes.aliveIndices();
+        auto positions = cubes.cubePositions();
+        auto scales = cubes.cubeScales();
+
+        m_entries.resize(count);
+        m_entrySpheres.resize(count);
+        m_cubeSpheres.resize(count);
+        m_cubeCells.resize(count);
+        m_cubeRanks.resize(count);
+        if (count == 0)
+        {
+            m_dimensions[0] = m_dimensions[1] = m_dimensions[2] = 0;
+            m_maxRadius = 0.0f;
+            m_cellStarts.assign(1, 0);
+            return;
+        }
+
+        // Gather the bounding spheres of all cubes, and find their bounds
+        m_chunkBounds.resize((count + BUILD_CHUNK_SIZE - 1) / BUILD_CHUNK_SIZE);
+        forEachRange(count, [&](size_t begin, size_t end)
+        {
+            ChunkBounds bounds{ positions[indices[begin]], positions[indices[begin]], 0.0f };
+            for (size_t k = begin; k < end; k++)
+            {
+                auto i = indices[k];
+                auto radius = std::abs(scales[i]) * CUBE_BOUNDING_RADIUS;
+                m_cubeSpheres[k] = glm::vec4(positions[i], radius);
+                bounds.min = glm::min(bounds.min, positions[i]);
+                bounds.max = glm::max(bounds.max, positions[i]);
+                bounds.maxRadius = std::max(bounds.maxRadius, radius);
+            }
+            m_chunkBounds[begin / BUILD_CHUNK_SIZE] = bounds;
+        });
+
+        auto bounds = m_chunkBounds[0];
+        for (const auto& chunk : m_chunkBounds)
+        {
+            bounds.min = glm::min(bounds.min, chunk.min);
+            bounds.max = glm::max(bounds.max, chunk.max);
+            bounds.maxRadius = std::max(bounds.maxRadius, chunk.maxRadius);
+        }
+
+        // Lay out the grid, growing the cells if there would be too many of them
+        m_origin = bounds.min;
+        m_maxRadius = bounds.maxRadius;
+        m_cellSize = m_requestedCellSize;
+        size_t cellTotal;
+        while (true)
+        {
+            cellTotal = 1;
+            for (auto axis = 0; axis < 3; axis++)
+            {
+                m_dimensions[axis] = int((bounds.max[axis] - bounds.min[axis]) / m_cellSize) + 1;
+                cellTotal *= size_t(m_dimensions[axis]);
+            }
+            if (cellTotal <= MAX_CELLS)
+                break;
+            m_cellSize *= 1.25f;
+        }
+
+        if (m_cellCursorCapacity < cellTotal)
+        {
+            m_cellCursors.reset(new std::atomic<uint32_t>[cellTotal]);
+            m_cellCursorCapacity = cellTotal;
+        }
+        for (size_t c = 0; c < cellTotal; c++)
+            m_cellCursors[c].store(0, std::memory_order_relaxed);
+
+        // Count the cubes in each cell
+        forEachRange(count, [&](size_t begin, size_t end)
+        {
+            int coordinates[3];
+            for (size_t k = begin; k < end; k++)
+            {
+                cellCoordinates(glm::vec3(m_cubeSpheres[k]), coordinates);
+                auto cell = uint32_t((coordinates[2] * m_dimensions[1] + coordinates[1]) * m_dimensions[0] + coordinates[0]);
+                m_cubeCells[k] = cell;
+                m_cubeRanks[k] = m_cellCursors[cell].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        // Turn the counts into the first entry of each cell
+        m_cellStarts.resize(cellTotal + 1);
+        uint32_t start = 0;
+        for (size_t c = 0; c < cellTotal; c++)
+        {
+            m_cellStarts[c] = start;
+            start += m_cellCursors[c].load(std::memory_order_relaxed);
+        }
+        m_cellStarts[cellTotal] = start;
+
+        // Scatter the cubes into their cells. Parallel rebuilds may order the cubes
+        // within a cell differently, which doesn't matter to any query.
+        forEachRange(count, [&](size_t begin, size_t end)
+        {
+            for (size_t k = begin; k < end; k++)
+            {
+                auto entry = m_cellStarts[m_cubeCells[k]] + m_cubeRanks[k];
+                m_entries[entry] = indices[k];
+                m_entrySpheres[entry] = m_cubeSpheres[k];
+            }
+        });
+    }
+
+    void SpatialGrid::appendCell(size_t cell, std::vector<uint32_t>& out) const
+    {
+        out.insert(out.end(), m_entries.begin() + m_cellStarts[cell], m_entries.begin() + m_cellStarts[cell + 1]);
+    }
+
+    template<typename Test>
+    void SpatialGrid::queryCells(const glm::vec3& min, const glm::vec3& max, const Test& test, std::vector<uint32_t>& out) const
+    {
+        if (m_entries.empty())
+            return;
+
+        // Cubes are sorted by their centers, so look for centers up to the largest radius outside the volume
+        auto lo = min - glm::vec3(m_maxRadius);
+        auto hi = max + glm::vec3(m_maxRadius);
+        for (auto axis = 0; axis < 3; axis++)
+        {
+            if (hi[axis] < m_origin[axis] || lo[axis] > m_origin[axis] + m_dimensions[axis] * m_cellSize)
+                return;
+        }
+
+        int first[3], last[3];
+        cellCoordinates(lo, first);
+        cellCoordinates(hi, last);
+        for (auto z = first[2]; z <= last[2]; z++)
+        {
+            for (auto y = first[1]; y <= last[1]; y++)
+            {
+                auto row = size_t(z * m_dimensions[1] + y) * m_dimensions[0];
+                for (auto e = m_cellStarts[row + first[0]]; e < m_cellStarts[row + last[0] + 1]; e++)
+                {
+                    if (test(m_entrySpheres[e]))
+                        out.push_back(m_entries[e]);
+                }
+            }
+        }
+    }
+
+    void SpatialGrid::queryBox(const glm::vec3& min, const glm::vec3& max, std::vector<uint32_t>& out) const
+    {
+        queryCells(min, max, [&](const glm::vec4& sphere)
+        {
+            auto center = glm::vec3(sphere);
+            auto offset = center - glm::clamp(center, min, max);
+            return glm::dot(offset, offset) <= sphere.w * sphere.w;
+        }, out);
+    }
+
+    void SpatialGrid::querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const
+    {
+        queryCells(center - glm::vec3(radius), center + glm::vec3(radius), [&](const glm::vec4& sphere)
+        {
+            auto offset = glm::vec3(sphere) - center;
+            auto reach = radius + sphere.w;
+            return glm::dot(offset, offset) <= reach * reach;
+        }, out);
+    }
+
+    void SpatialGrid::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const
+    {
+        // Cells completely inside the frustum are taken as a whole, only cells on its border test each cube
+        auto padding = glm::vec3(m_maxRadius);
+        for (auto z = 0; z < m_dimensions[2]; z++)
+        {
+            for (auto y = 0; y < m_dimensions[1]; y++)
+            {
+                for (auto x = 0; x < m_dimensions[0]; x++)
+                {
+                    auto cell = size_t(z * m_dimensions[1] + y) * m_dimensions[0] + x;
+                    if (m_cellStarts[cell] == m_cellStarts[cell + 1])
+                        continue;
+
+                    auto cellMin = m_origin + glm::vec3(float(x), float(y), float(z)) * m_cellSize;
+                    auto cellMax = cellMin + glm::vec3(m_cellSize);
+                    auto containment = frustum.classifyBox(cellMin - padding, cellMax + padding);
+                    if (containment == Containment::Inside)
+                        appendCell(cell, out);
+                    else if (containment == Containment::Intersects)
+                    {
+                        for (auto e = m_cellStarts[cell]; e < m_cellStarts[cell + 1]; e++)
+                        {
+                            if (frustum.intersectsSphere(glm::vec3(m_entrySpheres[e]), m_entrySpheres[e].w))
+                                out.push_back(m_entries[e]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Frustum.hpp"
+#include "WorkerPool.hpp"
+#include "NonCopyable.hpp"
+#include "AlignedAllocator.hpp"
+#include "CubeController.hpp"
+
+namespace cubedemo
+{
+    // Uniform grid over the bounding spheres of all living cubes, answering "which cubes are in this region".
+    // Cubes are sorted by cell with a counting sort, so each cell is a contiguous range of entries.
+    // The grid only covers the bounds of the cubes at the last rebuild, and is rebuilt from scratch
+    // after every update, since almost every cube moves to another cell within a few updates anyway.
+    class SpatialGrid : NonCopyable
+    {
+    public:
+        static const size_t BUILD_CHUNK_SIZE = 4096; // Cubes processed as one unit of work in parallel rebuilds
+        static const size_t MAX_CELLS = 1 << 18; // Larger bounds make cells grow instead
+
+    private:
+        float m_requestedCellSize; // Edge length of cells, as given to the constructor
+        float m_cellSize; // Actual edge length of cells after the last rebuild
+        glm::vec3 m_origin; // Minimum corner of the grid
+        int m_dimensions[3]; // Amount of cells along each axis
+        float m_maxRadius; // Largest bounding radius of any indexed cube
+
+        AlignedVector<uint32_t> m_cellStarts; // First entry of each cell, plus the total entry count at the end
+        AlignedVector<uint32_t> m_entries; // Cube slots, sorted by cell
+        AlignedVector<glm::vec4> m_entrySpheres; // Bounding sphere of each entry (center, radius), sorted by cell
+        // Per-cube data in the order of the alive list, used while rebuilding
+        AlignedVector<glm::vec4> m_cubeSpheres; // Bounding sphere of each cube, gathered once so later passes read sequentially
+        AlignedVector<uint32_t> m_cubeCells; // Cell of each cube
+        AlignedVector<uint32_t> m_cubeRanks; // Position of each cube within its cell
+
+        std::unique_ptr<std::atomic<uint32_t>[]> m_cellCursors; // Per-cell counters used while sorting
+        size_t m_cellCursorCapacity;
+
+        // Bounds of the cubes in one chunk of the alive list
+        struct ChunkBounds
+        {
+            glm::vec3 min, max; // Bounding box of all centers
+            float maxRadius; // Largest bounding radius
+        };
+        std::vector<ChunkBounds> m_chunkBounds; // Used while rebuilding
+
+        WorkerPool *m_workers; // Pool for parallel rebuilds, or null to rebuild on the calling thread
+
+        void forEachRange(size_t count, const WorkerPool::RangeFunction& function);
+        void cellCoordinates(const glm::vec3& point, int coordinates[3]) const; // Cell containing point, clamped to the grid
+        void appendCell(size_t cell, std::vector<uint32_t>& out) const; // Append all entries of a cell
+
+        // Append the entries in the cells overlapping [min, max] that pass the given test
+        template<typename Test>
+        void queryCells(const glm::vec3& min, const glm::vec3& max, const Test& test, std::vector<uint32_t>& out) const;
+
+    public:
+        explicit SpatialGrid(float cellSize = 8.0f);
+
+        // Rebuild on the given pool from now on (null to go back to single-threaded rebuilds)
+        inline void setWorkerPool(WorkerPool *workers) { m_workers = workers; }
+
+        // Index the latest positions of all living cubes
+        void rebuild(const CubeController& cubes);
+
+        inline size_t size() const { return m_entries.size(); }
+        inline size_t cellCount() const { return m_cellStarts.empty() ? 0 : m_cellStarts.size() - 1; }
+        inline float cellSize() const { return m_cellSize; }
+
+        // Append the slots of all cubes whose bounding spheres intersect the given volume, in no particular order
+        void queryBox(const glm::vec3& min, const glm::vec3& max, std::vector<uint32_t>& out) const;
+        void querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+        void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+    };
+}
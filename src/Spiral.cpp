@@ -6,17 +6,331 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include "CpuFeatures.hpp"
+
+#ifdef CD_ARCH_X86
+#include <immintrin.h>
+#endif
+
 namespace cubedemo
 {
     static const float TWO_PI = glm::pi<float>() * 2.0f;
-    
+
+    // Constants for the batched sine/cosine approximation.
+    // The argument is reduced to [-pi/4, pi/4] (with pi/2 split into three parts,
+    // for precision), then evaluated with the minimax polynomials from Cephes.
+    static const float TWO_OVER_PI = 0.636619772367581343f;
+    static const float PIO2_1 = 1.5703125f;
+    static const float PIO2_2 = 4.837512969970703125e-4f;
+    static const float PIO2_3 = 7.54978995489188216e-8f;
+    static const float SIN_C1 = -1.6666654611e-1f;
+    static const float SIN_C2 = 8.3321608736e-3f;
+    static const float SIN_C3 = -1.9515295891e-4f;
+    static const float COS_C1 = 4.166664568298827e-2f;
+    static const float COS_C2 = -1.388731625493765e-3f;
+    static const float COS_C3 = 2.443315711809948e-5f;
+
+    // // //
+    // HelixArrays implementation
+    // // //
+
+    void HelixArrays::resize(size_t size)
+    {
+        r.resize(size);
+        h.resize(size);
+        t0.resize(size);
+        originX.resize(size);
+        originY.resize(size);
+        originZ.resize(size);
+    }
+
+    void HelixArrays::set(size_t index, const HelixData& helix)
+    {
+        r[index] = helix.r;
+        h[index] = helix.h;
+        t0[index] = helix.t0;
+        originX[index] = helix.position.x;
+        originY[index] = helix.position.y;
+        originZ[index] = helix.position.z;
+    }
+
+    HelixData HelixArrays::get(size_t index) const
+    {
+        return HelixData{ r[index], h[index], t0[index], glm::vec3{ originX[index], originY[index], originZ[index] } };
+    }
+
+    // // //
+    // Helix evaluation
+    // // //
+
     glm::vec3 mapOntoHelix(const HelixData& helix, float t)
     {
         auto x = helix.r * cos(t * TWO_PI + helix.t0);
         auto z = helix.r * sin(t * TWO_PI + helix.t0);
         auto y = helix.h * t;
         auto curvePos = glm::vec3 { x, y, z };
-        
+
         return helix.position + curvePos;
     }
+
+    // Scalar version of the SIMD sine/cosine below. Uses the same reduction and
+    // polynomials, so the vector tails match the rest of the batch.
+    static inline void sinCosApprox(float x, float& s, float& c)
+    {
+        auto q = int(std::lrint(x * TWO_OVER_PI));
+        auto qf = float(q);
+        auto r = x - qf * PIO2_1;
+        r = r - qf * PIO2_2;
+        r = r - qf * PIO2_3;
+        auto z = r * r;
+
+        auto sinPoly = ((SIN_C3 * z + SIN_C2) * z + SIN_C1) * z * r + r;
+        auto cosPoly = ((COS_C3 * z + COS_C2) * z + COS_C1) * z * z - 0.5f * z + 1.0f;
+
+        // Select the quadrant
+        s = (q & 1) ? cosPoly : sinPoly;
+        c = (q & 1) ? sinPoly : cosPoly;
+        if (q & 2)
+            s = -s;
+        if ((q + 1) & 2)
+            c = -c;
+    }
+
+    glm::vec3 mapOntoHelixAt(const HelixArrays& helices, const float *startTimes, float time, float timeScale, size_t index)
+    {
+        auto t = timeScale * (time - startTimes[index]);
+        float s, c;
+        sinCosApprox(t * TWO_PI + helices.t0[index], s, c);
+        return glm::vec3{ helices.originX[index] + helices.r[index] * c, helices.originY[index] + helices.h[index] * t, helices.originZ[index] + helices.r[index] * s };
+    }
+
+    // The kernels below evaluate the elements [first, end). Element k is helix indices[k],
+    // or simply helix k if no indices are given.
+
+    static void mapOntoHelixScalar(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t first, size_t end, glm::vec3 *out)
+    {
+        for (size_t k = first; k < end; k++)
+        {
+            auto i = indices != nullptr ? indices[k] : k;
+            out[i] = mapOntoHelixAt(helices, startTimes, time, timeScale, i);
+        }
+    }
+
+#ifdef CD_ARCH_X86
+    CD_TARGET_SSE2 static inline void sinCos4(__m128 x, __m128& s, __m128& c)
+    {
+        auto q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+        auto qf = _mm_cvtepi32_ps(q);
+        auto r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_3)));
+        auto z = _mm_mul_ps(r, r);
+
+        auto sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C3), z), _mm_set1_ps(SIN_C2));
+        sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(SIN_C1));
+        sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), r), r);
+
+        auto cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_C3), z), _mm_set1_ps(COS_C2));
+        cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(COS_C1));
+        cosPoly = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cosPoly, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+        cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+        auto one = _mm_set1_epi32(1);
+        auto two = _mm_set1_epi32(2);
+        auto swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+        auto sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+        auto cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+
+        s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly)), sinSign);
+        c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly)), cosSign);
+    }
+
+    CD_TARGET_SSE2 static inline __m128 load4(const float *base, const uint32_t *indices, size_t i)
+    {
+        if (indices == nullptr)
+            return _mm_loadu_ps(base + i);
+        return _mm_set_ps(base[indices[i + 3]], base[indices[i + 2]], base[indices[i + 1]], base[indices[i]]);
+    }
+
+    CD_TARGET_SSE2 static size_t mapOntoHelixSSE2(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t first, size_t end, glm::vec3 *out)
+    {
+        const auto timeV = _mm_set1_ps(time);
+        const auto scaleV = _mm_set1_ps(timeScale);
+        const auto twoPiV = _mm_set1_ps(TWO_PI);
+
+        auto i = first;
+        for (; i + 4 <= end; i += 4)
+        {
+            auto t = _mm_mul_ps(scaleV, _mm_sub_ps(timeV, load4(startTimes, indices, i)));
+            auto angle = _mm_add_ps(_mm_mul_ps(t, twoPiV), load4(helices.t0.data(), indices, i));
+            __m128 s, c;
+            sinCos4(angle, s, c);
+
+            auto r = load4(helices.r.data(), indices, i);
+            alignas(16) float xs[4], ys[4], zs[4];
+            _mm_store_ps(xs, _mm_add_ps(load4(helices.originX.data(), indices, i), _mm_mul_ps(r, c)));
+            _mm_store_ps(ys, _mm_add_ps(load4(helices.originY.data(), indices, i), _mm_mul_ps(load4(helices.h.data(), indices, i), t)));
+            _mm_store_ps(zs, _mm_add_ps(load4(helices.originZ.data(), indices, i), _mm_mul_ps(r, s)));
+            for (size_t k = 0; k < 4; k++)
+                out[indices != nullptr ? indices[i + k] : i + k] = glm::vec3{ xs[k], ys[k], zs[k] };
+        }
+        return i;
+    }
+
+    CD_TARGET_AVX2 static inline void sinCos8(__m256 x, __m256& s, __m256& c)
+    {
+        auto q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)));
+        auto qf = _mm256_cvtepi32_ps(q);
+        auto r = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_1)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_2)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_3)));
+        auto z = _mm256_mul_ps(r, r);
+
+        auto sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_C3), z), _mm256_set1_ps(SIN_C2));
+        sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(SIN_C1));
+        sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), r), r);
+
+        auto cosPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_C3), z), _mm256_set1_ps(COS_C2));
+        cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(COS_C1));
+        cosPoly = _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z), _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+        cosPoly = _mm256_add_ps(cosPoly, _mm256_set1_ps(1.0f));
+
+        auto one = _mm256_set1_epi32(1);
+        auto two = _mm256_set1_epi32(2);
+        auto swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+        auto sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+        auto cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+
+        s = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, swap), sinSign);
+        c = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, swap), cosSign);
+    }
+
+    CD_TARGET_AVX2 static inline __m256 load8(const float *base, const uint32_t *indices, size_t i)
+    {
+        if (indices == nullptr)
+            return _mm256_loadu_ps(base + i);
+        return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i)), 4);
+    }
+
+    CD_TARGET_AVX2 static size_t mapOntoHelixAVX2(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t first, size_t end, glm::vec3 *out)
+    {
+        const auto timeV = _mm256_set1_ps(time);
+        const auto scaleV = _mm256_set1_ps(timeScale);
+        const auto twoPiV = _mm256_set1_ps(TWO_PI);
+
+        auto i = first;
+        for (; i + 8 <= end; i += 8)
+        {
+            auto t = _mm256_mul_ps(scaleV, _mm256_sub_ps(timeV, load8(startTimes, indices, i)));
+            auto angle = _mm256_add_ps(_mm256_mul_ps(t, twoPiV), load8(helices.t0.data(), indices, i));
+            __m256 s, c;
+            sinCos8(angle, s, c);
+
+            auto r = load8(helices.r.data(), indices, i);
+            alignas(32) float xs[8], ys[8], zs[8];
+            _mm256_store_ps(xs, _mm256_add_ps(load8(helices.originX.data(), indices, i), _mm256_mul_ps(r, c)));
+            _mm256_store_ps(ys, _mm256_add_ps(load8(helices.originY.data(), indices, i), _mm256_mul_ps(load8(helices.h.data(), indices, i), t)));
+            _mm256_store_ps(zs, _mm256_add_ps(load8(helices.originZ.data(), indices, i), _mm256_mul_ps(r, s)));
+            for (size_t k = 0; k < 8; k++)
+                out[indices != nullptr ? indices[i + k] : i + k] = glm::vec3{ xs[k], ys[k], zs[k] };
+        }
+        return i;
+    }
+
+    CD_TARGET_AVX512 static inline void sinCos16(__m512 x, __m512& s, __m512& c)
+    {
+        auto q = _mm512_cvtps_epi32(_mm512_mul_ps(x, _mm512_set1_ps(TWO_OVER_PI)));
+        auto qf = _mm512_cvtepi32_ps(q);
+        auto r = _mm512_sub_ps(x, _mm512_mul_ps(qf, _mm512_set1_ps(PIO2_1)));
+        r = _mm512_sub_ps(r, _mm512_mul_ps(qf, _mm512_set1_ps(PIO2_2)));
+        r = _mm512_sub_ps(r, _mm512_mul_ps(qf, _mm512_set1_ps(PIO2_3)));
+        auto z = _mm512_mul_ps(r, r);
+
+        auto sinPoly = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(SIN_C3), z), _mm512_set1_ps(SIN_C2));
+        sinPoly = _mm512_add_ps(_mm512_mul_ps(sinPoly, z), _mm512_set1_ps(SIN_C1));
+        sinPoly = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(sinPoly, z), r), r);
+
+        auto cosPoly = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(COS_C3), z), _mm512_set1_ps(COS_C2));
+        cosPoly = _mm512_add_ps(_mm512_mul_ps(cosPoly, z), _mm512_set1_ps(COS_C1));
+        cosPoly = _mm512_sub_ps(_mm512_mul_ps(_mm512_mul_ps(cosPoly, z), z), _mm512_mul_ps(_mm512_set1_ps(0.5f), z));
+        cosPoly = _mm512_add_ps(cosPoly, _mm512_set1_ps(1.0f));
+
+        auto one = _mm512_set1_epi32(1);
+        auto two = _mm512_set1_epi32(2);
+        auto swap = _mm512_test_epi32_mask(q, one);
+        auto sinSign = _mm512_slli_epi32(_mm512_and_si512(q, two), 30);
+        auto cosSign = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(q, one), two), 30);
+
+        // Plain AVX-512F has no float xor, so flip the sign bits as integers
+        s = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, sinPoly, cosPoly)), sinSign));
+        c = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, cosPoly, sinPoly)), cosSign));
+    }
+
+    CD_TARGET_AVX512 static inline __m512 load16(const float *base, const uint32_t *indices, size_t i)
+    {
+        if (indices == nullptr)
+            return _mm512_loadu_ps(base + i);
+        return _mm512_i32gather_ps(_mm512_loadu_si512(indices + i), base, 4);
+    }
+
+    CD_TARGET_AVX512 static size_t mapOntoHelixAVX512(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t first, size_t end, glm::vec3 *out)
+    {
+        const auto timeV = _mm512_set1_ps(time);
+        const auto scaleV = _mm512_set1_ps(timeScale);
+        const auto twoPiV = _mm512_set1_ps(TWO_PI);
+
+        auto i = first;
+        for (; i + 16 <= end; i += 16)
+        {
+            auto t = _mm512_mul_ps(scaleV, _mm512_sub_ps(timeV, load16(startTimes, indices, i)));
+            auto angle = _mm512_add_ps(_mm512_mul_ps(t, twoPiV), load16(helices.t0.data(), indices, i));
+            __m512 s, c;
+            sinCos16(angle, s, c);
+
+            auto r = load16(helices.r.data(), indices, i);
+            alignas(64) float xs[16], ys[16], zs[16];
+            _mm512_store_ps(xs, _mm512_add_ps(load16(helices.originX.data(), indices, i), _mm512_mul_ps(r, c)));
+            _mm512_store_ps(ys, _mm512_add_ps(load16(helices.originY.data(), indices, i), _mm512_mul_ps(load16(helices.h.data(), indices, i), t)));
+            _mm512_store_ps(zs, _mm512_add_ps(load16(helices.originZ.data(), indices, i), _mm512_mul_ps(r, s)));
+            for (size_t k = 0; k < 16; k++)
+                out[indices != nullptr ? indices[i + k] : i + k] = glm::vec3{ xs[k], ys[k], zs[k] };
+        }
+        return i;
+    }
+#endif
+
+    static void mapOntoHelixDispatch(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t first, size_t end, glm::vec3 *out)
+    {
+        auto i = first;
+
+#ifdef CD_ARCH_X86
+        switch (simdLevel())
+        {
+        case SimdLevel::AVX512:
+            i = mapOntoHelixAVX512(helices, startTimes, time, timeScale, indices, i, end, out);
+            break;
+        case SimdLevel::AVX2:
+            i = mapOntoHelixAVX2(helices, startTimes, time, timeScale, indices, i, end, out);
+            break;
+        case SimdLevel::SSE2:
+            i = mapOntoHelixSSE2(helices, startTimes, time, timeScale, indices, i, end, out);
+            break;
+        default:
+            break;
+        }
+#endif
+
+        // Remaining elements that don't fill a whole vector
+        mapOntoHelixScalar(helices, startTimes, time, timeScale, indices, i, end, out);
+    }
+
+    void mapOntoHelixN(const HelixArrays& helices, const float *startTimes, float time, float timeScale, size_t first, size_t count, glm::vec3 *out)
+    {
+        mapOntoHelixDispatch(helices, startTimes, time, timeScale, nullptr, first, first + count, out);
+    }
+
+    void mapOntoHelixIndexed(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t count, glm::vec3 *out)
+    {
+        mapOntoHelixDispatch(helices, startTimes, time, timeScale, indices, 0, count, out);
+    }
 }
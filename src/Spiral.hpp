@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/vec3.hpp>
 
+#include "AlignedAllocator.hpp"
+
 namespace cubedemo
 {
     // Contains the parameters of a helix curve
@@ -12,10 +17,40 @@ namespace cubedemo
         float t0; // Initial Offset
         glm::vec3 position; // The origin (position at t=0) of the helix curve
     };
-    
+
+    // The parameters of many helix curves, stored as structure-of-arrays
+    // so that several of them can be evaluated at once using SIMD instructions
+    struct HelixArrays final
+    {
+        AlignedVector<float> r; // Radius
+        AlignedVector<float> h; // Distance traveled per revolution
+        AlignedVector<float> t0; // Initial offset
+        AlignedVector<float> originX, originY, originZ; // Origin of the helix curve
+
+        void resize(size_t size);
+        void set(size_t index, const HelixData& helix);
+        HelixData get(size_t index) const;
+    };
+
     // Maps a given position onto a helix
     //   pos: A three-dimensional coordinate
     //   helix: A HelixData object
     //   t: Elapsed time in seconds
     glm::vec3 mapOntoHelix(const HelixData& helix, float t);
+
+    // Maps a range of helices at once, using the widest instruction set available
+    //   helices: Helix parameters
+    //   startTimes: Per-helix start times, in seconds
+    //   time: Current time, in seconds
+    //   timeScale: The curve is evaluated at t = timeScale * (time - startTimes[i])
+    //   first, count: The range of helices to evaluate
+    //   out: Receives the positions, indexed like the helix arrays
+    void mapOntoHelixN(const HelixArrays& helices, const float *startTimes, float time, float timeScale, size_t first, size_t count, glm::vec3 *out);
+
+    // Like mapOntoHelixN, but only evaluates the helices listed in indices[0..count)
+    void mapOntoHelixIndexed(const HelixArrays& helices, const float *startTimes, float time, float timeScale, const uint32_t *indices, size_t count, glm::vec3 *out);
+
+    // Evaluates a single helix, with results identical to those of mapOntoHelixN.
+    // mapOntoHelix uses the standard library sine and cosine, which differ in the last bits.
+    glm::vec3 mapOntoHelixAt(const HelixArrays& helices, const float *startTimes, float time, float timeScale, size_t index);
 }
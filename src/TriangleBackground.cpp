@@ -55,7 +55,7 @@ namespace cubedemo
 	}
 
 	TriangleBackground::TriangleBackground(size_t hcount, size_t vcount)
-		: m_hcount{ hcount }, m_vcount{ vcount }
+		: m_hcount{ hcount }, m_vcount{ vcount }, m_brightnessData(hcount * vcount)
 	{
 		// Generate buffers etc
 		gl::GenVertexArrays(1, &m_vao);
@@ -117,20 +117,19 @@ namespace cubedemo
 
 	void TriangleBackground::update(const GameTimePoint& time)
 	{
-		std::vector<float> brightnessData;
 		for (size_t y = 0; y < m_vcount; y++)
 		{
 			for (size_t x = 0; x < m_hcount; x++)
 			{
 				auto noise = 0.5f * (1 + glm::simplex(glm::vec3{ float(x), float(y), time.total() * 0.30f }));
-				brightnessData.push_back(noise);
+				m_brightnessData[y * m_hcount + x] = noise;
 			}
 		}
 
 		// Copy data into brightness VBO
 		gl::BindBuffer(gl::ARRAY_BUFFER, m_brightnessVBO);
 		{
-			gl::BufferSubData(gl::ARRAY_BUFFER, 0, sizeof(float) * brightnessData.size(), brightnessData.data());
+			gl::BufferSubData(gl::ARRAY_BUFFER, 0, sizeof(float) * m_brightnessData.size(), m_brightnessData.data());
 		}
 		gl::BindBuffer(gl::ARRAY_BUFFER, 0);
 		GL_CHECK_ERRORS;
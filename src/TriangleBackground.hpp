@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "gl_core_4_1.hpp"
 #include "GLShader.hpp"
 #include "GameTime.hpp"
@@ -21,6 +23,7 @@ namespace cubedemo
         
         GLsizei m_elementCount; // Count of indices to draw
         size_t m_hcount, m_vcount; // Amount of triangles in horizontal and vertical directions
+        std::vector<float> m_brightnessData; // Brightness of each vertex, kept around so updates don't allocate
         
     public:
         TriangleBackground(size_t hcount, size_t vcount);
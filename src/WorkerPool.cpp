@@ -0,0 +1,155 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+#include "Util.hpp"
+
+namespace cubedemo
+{
+    static inline uint64_t packRange(uint32_t first, uint32_t end)
+    {
+        return (uint64_t(first) << 32) | end;
+    }
+
+    static inline uint32_t rangeFirst(uint64_t range) { return uint32_t(range >> 32); }
+    static inline uint32_t rangeEnd(uint64_t range) { return uint32_t(range & 0xffffffffu); }
+
+    WorkerPool::WorkerPool(size_t threadCount)
+        : m_ranges{ new ChunkRange[threadCount + 1] },
+        m_generation{ 0 }, m_busyWorkers{ 0 }, m_stopping{ false },
+        m_function{ nullptr }, m_count{ 0 }, m_grain{ 1 }
+    {
+        for (size_t i = 0; i <= threadCount; i++)
+            m_ranges[i].range.store(0);
+
+        m_threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+            m_threads.emplace_back(&WorkerPool::workerMain, this, i + 1);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stopping = true;
+        }
+        m_wakeCondition.notify_all();
+
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    size_t WorkerPool::defaultThreadCount()
+    {
+        auto hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    void WorkerPool::workerMain(size_t index)
+    {
+        uint64_t seenGeneration = 0;
+
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        while (true)
+        {
+            m_wakeCondition.wait(lock, [&] { return m_stopping || (m_function != nullptr && m_generation != seenGeneration); });
+            if (m_stopping)
+                return;
+
+            seenGeneration = m_generation;
+            auto function = m_function;
+            m_busyWorkers++;
+            lock.unlock();
+
+            runChunks(index, *function);
+
+            lock.lock();
+            if (--m_busyWorkers == 0)
+                m_doneCondition.notify_all();
+        }
+    }
+
+    bool WorkerPool::takeOwnChunk(size_t index, uint32_t& chunk)
+    {
+        auto& slot = m_ranges[index].range;
+        auto range = slot.load(std::memory_order_acquire);
+        while (rangeFirst(range) < rangeEnd(range))
+        {
+            if (slot.compare_exchange_weak(range, packRange(rangeFirst(range) + 1, rangeEnd(range)), std::memory_order_acq_rel))
+            {
+                chunk = rangeFirst(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool WorkerPool::stealChunk(size_t index, uint32_t& chunk)
+    {
+        auto participants = concurrency();
+        for (size_t offset = 1; offset < participants; offset++)
+        {
+            auto& slot = m_ranges[(index + offset) % participants].range;
+            auto range = slot.load(std::memory_order_acquire);
+            while (rangeFirst(range) < rangeEnd(range))
+            {
+                if (slot.compare_exchange_weak(range, packRange(rangeFirst(range), rangeEnd(range) - 1), std::memory_order_acq_rel))
+                {
+                    chunk = rangeEnd(range) - 1;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void WorkerPool::runChunks(size_t index, const RangeFunction& function)
+    {
+        uint32_t chunk;
+        while (takeOwnChunk(index, chunk) || stealChunk(index, chunk))
+        {
+            auto begin = size_t(chunk) * m_grain;
+            auto end = std::min(m_count, begin + m_grain);
+            function(begin, end);
+        }
+    }
+
+    void WorkerPool::parallelFor(size_t count, size_t grain, const RangeFunction& function)
+    {
+        CC_ASSERT(grain > 0)
+        auto chunks = (count + grain - 1) / grain;
+        if (m_threads.empty() || chunks <= 1)
+        {
+            for (size_t begin = 0; begin < count; begin += grain)
+                function(begin, std::min(count, begin + grain));
+            return;
+        }
+
+        // Hand out contiguous shares of the chunks to every participant
+        auto participants = concurrency();
+        for (size_t i = 0; i < participants; i++)
+        {
+            auto first = uint32_t(chunks * i / participants);
+            auto end = uint32_t(chunks * (i + 1) / participants);
+            m_ranges[i].range.store(packRange(first, end), std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_count = count;
+            m_grain = grain;
+            m_function = &function;
+            m_generation++;
+        }
+        m_wakeCondition.notify_all();
+
+        // The calling thread works on its own share as well
+        runChunks(0, function);
+
+        // All chunks have been taken at this point. Wait for the workers that are still
+        // running one; workers that wake up from now on won't join this loop anymore.
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_function = nullptr;
+        m_doneCondition.wait(lock, [&] { return m_busyWorkers == 0; });
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <condition_variable>
+
+#include "NonCopyable.hpp"
+
+namespace cubedemo
+{
+    // A persistent pool of worker threads for data-parallel loops.
+    // Each participant starts out with a contiguous share of the chunks and
+    // takes them from the front; when it runs dry it steals from the back of
+    // the others' shares, so uneven chunks still keep every thread busy.
+    class WorkerPool : NonCopyable
+    {
+    public:
+        // Non-owning reference to a loop body called as function(begin, end). Unlike std::function
+        // it never allocates, and parallelFor doesn't return before the body is done with anyway.
+        class RangeFunction
+        {
+        private:
+            const void *m_function;
+            void (*m_call)(const void*, size_t, size_t);
+
+            template<typename Function>
+            static void call(const void *function, size_t begin, size_t end) { (*static_cast<const Function*>(function))(begin, end); }
+
+        public:
+            template<typename Function>
+            RangeFunction(const Function& function) : m_function{ &function }, m_call{ &call<Function> } { }
+
+            inline void operator()(size_t begin, size_t end) const { m_call(m_function, begin, end); }
+        };
+
+    private:
+        // The chunks a participant still owns, packed as (first << 32 | end)
+        // so both owner and thieves can take chunks with a single CAS.
+        // Padded to a cache line to keep the participants from false sharing.
+        struct ChunkRange
+        {
+            std::atomic<uint64_t> range;
+            char padding[64 - sizeof(std::atomic<uint64_t>)];
+        };
+
+        std::vector<std::thread> m_threads;
+        std::unique_ptr<ChunkRange[]> m_ranges; // One per worker, plus one for the calling thread
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition; // Signaled when a new loop is started
+        std::condition_variable m_doneCondition; // Signaled when the last busy worker finishes
+        uint64_t m_generation; // Incremented for every loop
+        size_t m_busyWorkers; // Amount of workers currently taking part in a loop
+        bool m_stopping;
+
+        const RangeFunction *m_function; // The loop body, or null when no loop is running
+        size_t m_count; // Total amount of elements
+        size_t m_grain; // Elements per chunk
+
+        void workerMain(size_t index);
+        void runChunks(size_t index, const RangeFunction& function);
+        bool takeOwnChunk(size_t index, uint32_t& chunk);
+        bool stealChunk(size_t index, uint32_t& chunk);
+
+    public:
+        // threadCount: Amount of worker threads to start, in addition to the calling thread.
+        // By default, one less than the number of hardware threads.
+        explicit WorkerPool(size_t threadCount = defaultThreadCount());
+        ~WorkerPool();
+
+        static size_t defaultThreadCount();
+
+        // Amount of threads taking part in each loop, including the calling thread
+        inline size_t concurrency() const { return m_threads.size() + 1; }
+
+        // Call function(begin, end) for consecutive chunks of grain elements covering [0, count),
+        // distributed over all workers and the calling thread. Blocks until all chunks are done.
+        void parallelFor(size_t count, size_t grain, const RangeFunction& function);
+    };
+}